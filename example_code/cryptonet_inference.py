@@ -41,7 +41,8 @@ def main() -> None:
 
     # Define operations
     operations = [
-        neuralpy.Conv2D(np.load("model/_Conv_0_weights.npy"), np.load("model/_Conv_0_bias.npy")),
+        neuralpy.PackedConv2D.FromMatrix(np.load("model/_Conv_0_weights.npy"), np.load("model/_Conv_0_bias.npy"),
+                                         input_shape=(32, 32), kernel_size=5, stride=3),
         neuralpy.ReLU(-6.5318193435668945, 8.548895835876465, 3),
         neuralpy.Gemm(np.load("model/_Gemm_3_w.npy"), np.load("model/_Gemm_3_bias.npy")),
         neuralpy.ReLU(-14.685586750507355, 12.968225657939911, 3),
@@ -0,0 +1,36 @@
+import neuralpy
+import numpy as np
+from os import listdir
+
+
+def main() -> None:
+    # Generate context and keypair object in order to load them from file
+    context = neuralpy.Context()
+    publicKey = neuralpy.PublicKey()
+
+    context.load("keys/context")
+    publicKey.load("keys/publicKey")
+
+    # Encrypting all images into a single dataset file
+    filenames = sorted(listdir("images"), key=lambda name: int(name.split(".")[0]))
+
+    with neuralpy.DatasetWriter("images.ctds") as writer:
+        for filename in filenames:
+            image = list(np.load("images/" + filename)[0][0].flat)
+
+            x = context.Encrypt(context.PackPlaintext(image), publicKey)
+            x.setSlots(len(image))
+            writer.append(x)
+
+    # Reading the dataset back in batches, ciphertexts are deserialized directly from the memory mapped file
+    reader = neuralpy.DatasetReader("images.ctds")
+    print("Dataset holds {} encrypted images".format(len(reader)))
+
+    batch_size = 16
+    for start in range(0, len(reader), batch_size):
+        batch = reader.getBatch(start, batch_size)
+        print("Loaded images {} to {}".format(start, start + len(batch) - 1))
+
+
+if __name__ == "__main__":
+    main()
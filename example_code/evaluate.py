@@ -0,0 +1,179 @@
+import neuralpy
+import numpy as np
+import argparse
+import json
+from concurrent.futures import ThreadPoolExecutor
+from os import listdir, path
+from time import perf_counter
+
+
+def relu(x: np.ndarray) -> np.ndarray:
+    return np.maximum(x, 0)
+
+
+def relu_layer(lower: float, upper: float, degree: int) -> tuple:
+    """
+    Encrypted ReLU together with the Chebyshev polynomial it evaluates, which has the same coefficients as a
+    PolynomialActivation of the same interval and degree.
+    """
+    polynomial = np.vectorize(neuralpy.PolynomialActivation("relu", lower, upper, degree).EvalPlain)
+    return neuralpy.ReLU(lower, upper, degree), relu, polynomial
+
+
+def load_model(model_dir: str) -> list:
+    """
+    Load the cryptonet layers as tuples of a name, the encrypted operator, the exact plaintext function of the layer and
+    the plaintext function the encrypted operator computes, which differs from the exact one for the activations.
+    """
+    def load(name):
+        return np.load(path.join(model_dir, name))
+
+    conv_w, conv_b = load("_Conv_0_weights.npy"), load("_Conv_0_bias.npy")
+    gemm3_w, gemm3_b = load("_Gemm_3_w.npy"), load("_Gemm_3_bias.npy")
+    gemm5_w, gemm5_b = load("_Gemm_5_w.npy"), load("_Gemm_5_bias.npy")
+
+    def linear(weights, bias):
+        return lambda x: x @ weights + bias
+
+    return [
+        ("Conv_1", neuralpy.PackedConv2D.FromMatrix(conv_w, conv_b, input_shape=(32, 32), kernel_size=5, stride=3),
+         linear(conv_w, conv_b), linear(conv_w, conv_b)),
+        ("ReLU_1", *relu_layer(-6.5318193435668945, 8.548895835876465, 3)),
+        ("Gemm_1", neuralpy.Gemm(gemm3_w, gemm3_b), linear(gemm3_w, gemm3_b), linear(gemm3_w, gemm3_b)),
+        ("ReLU_2", *relu_layer(-14.685586750507355, 12.968225657939911, 3)),
+        ("Gemm_2", neuralpy.Gemm(gemm5_w, gemm5_b), linear(gemm5_w, gemm5_b), linear(gemm5_w, gemm5_b)),
+    ]
+
+
+def evaluate_image(filename: str, context, keypair, layers: list) -> dict:
+    """
+    Classify an image encrypted, in plaintext with the exact activations and in plaintext with the polynomials the
+    encrypted activations evaluate, and record the latency of every layer.
+    """
+    image = np.load(filename)[0][0].astype(np.float64).flatten()
+
+    start = perf_counter()
+    x = context.Encrypt(context.PackPlaintext(list(image)), keypair.publicKey)
+    x.setSlots(len(image))
+    encrypt_time = perf_counter() - start
+
+    latencies = []
+    for _, operation, _, _ in layers:
+        start = perf_counter()
+        x = operation(x)
+        latencies.append(perf_counter() - start)
+
+    start = perf_counter()
+    output_size = x.getSlots()
+    result = context.Decrypt(x, keypair.privateKey)
+    result.SetLength(output_size)
+    encrypted = np.array(result.GetPackedValue())
+    decrypt_time = perf_counter() - start
+
+    plain, polynomial = image, image
+    for _, _, exact, approximation in layers:
+        plain, polynomial = exact(plain), approximation(polynomial)
+
+    return {
+        "file": path.basename(filename),
+        "encrypted": encrypted,
+        "plain": plain,
+        "polynomial": polynomial,
+        "latencies": latencies,
+        "encrypt": encrypt_time,
+        "decrypt": decrypt_time,
+    }
+
+
+def percentiles(values: list) -> dict:
+    values = np.array(values)
+    return {
+        "mean": float(values.mean()),
+        "p50": float(np.percentile(values, 50)),
+        "p90": float(np.percentile(values, 90)),
+        "p99": float(np.percentile(values, 99)),
+        "max": float(values.max()),
+    }
+
+
+def summarize(results: list, layers: list, wall_time: float, workers: int) -> dict:
+    def slot_errors(a, b):
+        return np.concatenate([np.abs(r[a] - r[b]) for r in results])
+
+    # Against the exact network both the approximation and the CKKS noise count, against the polynomials only the noise
+    errors = slot_errors("encrypted", "plain")
+    noise = slot_errors("encrypted", "polynomial")
+    approximation = slot_errors("polynomial", "plain")
+    agreement = [int(np.argmax(r["encrypted"]) == np.argmax(r["plain"])) for r in results]
+    polynomial_agreement = [int(np.argmax(r["encrypted"]) == np.argmax(r["polynomial"])) for r in results]
+
+    return {
+        "images": len(results),
+        "workers": workers,
+        "threads": neuralpy.GetThreads(),
+        "agreement": float(np.mean(agreement)),
+        "disagreeing_images": [r["file"] for r, agree in zip(results, agreement) if not agree],
+        "polynomial_agreement": float(np.mean(polynomial_agreement)),
+        "max_slot_error": float(errors.max()),
+        "mean_slot_error": float(errors.mean()),
+        "max_noise_error": float(noise.max()),
+        "mean_noise_error": float(noise.mean()),
+        "max_approximation_error": float(approximation.max()),
+        "mean_approximation_error": float(approximation.mean()),
+        "layers": [
+            dict(name=name, **percentiles([r["latencies"][i] for r in results]))
+            for i, (name, _, _, _) in enumerate(layers)
+        ],
+        "encrypt": percentiles([r["encrypt"] for r in results]),
+        "decrypt": percentiles([r["decrypt"] for r in results]),
+        "inference": percentiles([sum(r["latencies"]) for r in results]),
+        "images_per_second": len(results) / wall_time,
+    }
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description="Compare encrypted and plaintext inference on a directory of images.")
+    parser.add_argument("--images", default="images", help="Directory of images stored as .npy files")
+    parser.add_argument("--keys", default="keys", help="Directory the keys were stored in by keygen.py")
+    parser.add_argument("--model", default="model", help="Directory of the model weights")
+    parser.add_argument("--limit", type=int, default=0, help="Number of images to evaluate, all if zero")
+    parser.add_argument("--workers", type=int, default=4, help="Number of images evaluated at the same time")
+    parser.add_argument("--intra-op", type=int, default=0, help="OpenMP threads per operation, default if zero")
+    parser.add_argument("--output", default="", help="File the JSON report is written to, stdout if empty")
+    args = parser.parse_args()
+
+    context = neuralpy.Context()
+    keypair = neuralpy.KeyPair()
+
+    context.load(path.join(args.keys, "context"))
+    context.loadMultKeys(path.join(args.keys, "multKeys"))
+    context.loadRotKeys(path.join(args.keys, "rotKeys"))
+
+    keypair.publicKey.load(path.join(args.keys, "publicKey"))
+    keypair.privateKey.load(path.join(args.keys, "privateKey"))
+
+    neuralpy.SetContext(context)
+    neuralpy.SetThreads(intra_op=args.intra_op)
+
+    files = sorted((f for f in listdir(args.images) if f.endswith(".npy")), key=lambda f: (len(f), f))
+    if args.limit:
+        files = files[:args.limit]
+
+    layers = load_model(args.model)
+
+    start = perf_counter()
+    with ThreadPoolExecutor(max_workers=args.workers) as executor:
+        results = list(executor.map(
+            lambda f: evaluate_image(path.join(args.images, f), context, keypair, layers), files))
+    wall_time = perf_counter() - start
+
+    report = json.dumps(summarize(results, layers, wall_time, args.workers), indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(report)
+    else:
+        print(report)
+
+
+if __name__ == "__main__":
+    main()
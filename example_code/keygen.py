@@ -1,4 +1,10 @@
 import neuralpy
+import numpy as np
+
+
+# Shape of the MNIST images cryptonet_inference.py encrypts, every pixel takes one slot
+IMAGE_SHAPE = (32, 32)
+BATCH_SIZE = IMAGE_SHAPE[0] * IMAGE_SHAPE[1]
 
 
 def main() -> None:
@@ -9,7 +15,7 @@ def main() -> None:
     params.SetScalingModSize(29)
     # params.SetSecurityLevel(neuralpy.HEStd_128_classic)
     params.SetSecurityLevel(neuralpy.HEStd_NotSet)
-    params.SetBatchSize(1024)
+    params.SetBatchSize(BATCH_SIZE)
     params.SetScalingTechnique(neuralpy.FLEXIBLEAUTO)
     params.SetRingDim(8192)
 
@@ -29,8 +35,12 @@ def main() -> None:
     context.EvalMultKeyGen(keypair.privateKey)
     print("Done!")
 
+    # The packed convolution needs keys for its own rotations
+    conv = neuralpy.PackedConv2D.FromMatrix(np.load("model/_Conv_0_weights.npy"), np.load("model/_Conv_0_bias.npy"),
+                                            input_shape=IMAGE_SHAPE, kernel_size=5, stride=3)
+
     print("Generating rotation keys...")
-    context.GenRotateKeys(keypair.privateKey)
+    context.GenRotateKeys(keypair.privateKey, conv.GetRotationIndices(BATCH_SIZE))
     print("Done!")
 
     # Saving keys to file
@@ -0,0 +1,112 @@
+/**
+ * @file AsyncExecution.h
+ *
+ * @brief This file includes the glue between the TaskScheduler and Python. Work submitted from Python runs on the
+ * scheduler without the GIL, and its result is handed back through a concurrent.futures.Future, which can be waited on
+ * directly or awaited in asyncio after wrapping it with AsAwaitable.
+ */
+#ifndef NEURALPY_ASYNCEXECUTION_H
+#define NEURALPY_ASYNCEXECUTION_H
+
+#include <pybind11/pybind11.h>
+
+#include "PythonCiphertext.h"
+#include "Sequential.h"
+#include "TaskScheduler.h"
+
+namespace py = pybind11;
+
+
+/***
+ * Wraps a Python object so it can be kept alive by tasks running on other threads. The reference is released with the
+ * GIL held, regardless of the thread that drops the last copy.
+ *
+ * @param object
+ * @return Shared handle to the object
+ */
+std::shared_ptr<py::object> SharePythonObject(py::object object) {
+    return std::shared_ptr<py::object>(new py::object(std::move(object)), [](py::object* o) {
+        py::gil_scoped_acquire gil;
+        delete o;
+    });
+}
+
+
+/***
+ * Creates a concurrent.futures.Future together with a callback that completes it from any thread.
+ *
+ * @return The future and the callback
+ */
+std::pair<py::object, Sequential::Callback> MakePythonFuture() {
+    py::object future = py::module_::import("concurrent.futures").attr("Future")();
+    auto handle = SharePythonObject(future);
+
+    Sequential::Callback done = [handle](PythonCiphertext result, std::exception_ptr error) {
+        py::gil_scoped_acquire gil;
+        try {
+            if (!error) {
+                handle->attr("set_result")(py::cast(result));
+                return;
+            }
+
+            try {
+                std::rethrow_exception(error);
+            } catch (py::error_already_set& e) {
+                handle->attr("set_exception")(e.value());
+            } catch (const std::exception& e) {
+                handle->attr("set_exception")(py::module_::import("builtins").attr("RuntimeError")(e.what()));
+            }
+        } catch (py::error_already_set&) {
+            //  The future has been cancelled by the caller, nobody is waiting for the result
+        }
+    };
+
+    return {future, done};
+}
+
+
+/***
+ * Runs work on the TaskScheduler.
+ *
+ * @param work Function computing a ciphertext, must not touch Python objects
+ * @return concurrent.futures.Future completed with the result
+ */
+py::object SubmitPython(std::function<PythonCiphertext ()> work) {
+    auto future = MakePythonFuture();
+
+    TaskScheduler::instance().post([work = std::move(work), done = std::move(future.second)]() {
+        PythonCiphertext result;
+        try {
+            ApplyThreadBudget();
+            result = work();
+        } catch (...) {
+            done(PythonCiphertext(), std::current_exception());
+            return;
+        }
+        done(result, nullptr);
+    });
+
+    return future.first;
+}
+
+
+/***
+ * Wraps a concurrent.futures.Future into an asyncio future of the running event loop.
+ *
+ * @param future
+ * @return Awaitable
+ */
+py::object AsAwaitable(py::object future) {
+    return py::module_::import("asyncio").attr("wrap_future")(future);
+}
+
+
+/***
+ * Waits for all submitted work and stops the scheduler threads, registered to run at interpreter exit.
+ */
+void ShutdownScheduler() {
+    py::gil_scoped_release release;
+    TaskScheduler::instance().shutdown();
+}
+
+#endif //NEURALPY_ASYNCEXECUTION_H
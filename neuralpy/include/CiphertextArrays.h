@@ -0,0 +1,182 @@
+/**
+ * @file CiphertextArrays.h
+ *
+ * @brief This file includes the exchange of ciphertexts with NumPy without serialization. Every RNS limb of a
+ * ciphertext element is a separate allocation in OpenFHE, so a limb can be viewed without copying, while the whole
+ * ciphertext is exported as a uint64 array of shape (elements, limbs, ring_dim) with one memcpy per limb. The
+ * coefficients are in the format of the ciphertext, which is the evaluation (NTT) format for CKKS. Together with the
+ * metadata a ciphertext can be rebuilt from such an array under the context it was created with.
+ */
+#ifndef NEURALPY_CIPHERTEXTARRAYS_H
+#define NEURALPY_CIPHERTEXTARRAYS_H
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "PythonCiphertext.h"
+#include "PythonContext.h"
+
+namespace py = pybind11;
+
+static_assert(sizeof(NativeInteger) == sizeof(uint64_t), "RNS limbs can not be viewed as uint64 arrays.");
+
+
+/***
+ * Creates a NumPy view of a single RNS limb of a ciphertext. The view keeps the underlying OpenFHE ciphertext alive,
+ * which counts as another owner. In place operations on the ciphertext copy it before they modify it while a view
+ * exists, so a read only view never changes. Writes through a writable view are seen by the ciphertext only until it
+ * is copied, which happens on the next in place operation or writable view, so every earlier writable view is silently
+ * detached from the ciphertext then.
+ *
+ * @param x Ciphertext
+ * @param element Index of the ciphertext element
+ * @param limb Index of the RNS limb
+ * @param writable Whether the view may be written to
+ * @return uint64 array of shape (ring_dim,)
+ */
+py::array_t<uint64_t> GetLimbView(PythonCiphertext& x, uint32_t element, uint32_t limb, bool writable=false) {
+    Cipher cipher = writable ? x.getMutableCiphertext() : x.getCiphertext();
+    std::vector<DCRTPoly>& elements = cipher->GetElements();
+    if (element >= elements.size())
+        throw std::out_of_range("Ciphertext has only " + std::to_string(elements.size()) + " elements.");
+    if (limb >= elements[element].GetNumOfElements())
+        throw std::out_of_range("Ciphertext has only " + std::to_string(elements[element].GetNumOfElements()) +
+                                " RNS limbs.");
+
+    NativePoly& tower = elements[element].ElementAtIndex(limb);
+    auto* data = reinterpret_cast<uint64_t*>(&tower[0]);
+    py::capsule owner(new Cipher(cipher), [](void* p) { delete static_cast<Cipher*>(p); });
+
+    py::array_t<uint64_t> view({(py::ssize_t) tower.GetLength()}, {(py::ssize_t) sizeof(uint64_t)}, data, owner);
+    if (!writable)
+        view.attr("setflags")(py::arg("write")=false);
+
+    return view;
+}
+
+
+/***
+ * Copies all RNS limbs of a ciphertext into a single array.
+ *
+ * @param x Ciphertext
+ * @return uint64 array of shape (elements, limbs, ring_dim)
+ */
+py::array_t<uint64_t> CiphertextToArray(const PythonCiphertext& x) {
+    Cipher cipher = x.getCiphertext();
+    auto& elements = cipher->GetElements();
+    size_t limbs = elements[0].GetNumOfElements();
+    size_t ringDim = elements[0].GetRingDimension();
+
+    py::array_t<uint64_t> result({(py::ssize_t) elements.size(), (py::ssize_t) limbs, (py::ssize_t) ringDim});
+    uint64_t* out = result.mutable_data();
+    for (auto& element : elements) {
+        for (size_t limb = 0; limb < limbs; limb++) {
+            std::memcpy(out, &element.GetElementAtIndex(limb).GetValues()[0], ringDim * sizeof(uint64_t));
+            out += ringDim;
+        }
+    }
+
+    return result;
+}
+
+
+/***
+ * Metadata needed besides the limbs to rebuild a ciphertext.
+ *
+ * @param x Ciphertext
+ * @return Dictionary with level, noise_scale_degree, slots, scaling_factor and key_tag
+ */
+py::dict GetCiphertextMetadata(const PythonCiphertext& x) {
+    Cipher cipher = x.getCiphertext();
+
+    py::dict metadata;
+    metadata["level"] = cipher->GetLevel();
+    metadata["noise_scale_degree"] = cipher->GetNoiseScaleDeg();
+    metadata["slots"] = cipher->GetSlots();
+    metadata["scaling_factor"] = cipher->GetScalingFactor();
+    metadata["key_tag"] = cipher->GetKeyTag();
+
+    return metadata;
+}
+
+
+/***
+ * Rebuilds a ciphertext from its RNS limbs. The limbs have to be the first limbs of the moduli chain of the context,
+ * as is the case for every ciphertext created with it, and their number has to match the level in the metadata. Every
+ * coefficient has to be below the modulus of its limb.
+ *
+ * @param context Context the ciphertext was created with
+ * @param limbs uint64 array of shape (elements, limbs, ring_dim)
+ * @param metadata Dictionary as returned by GetCiphertextMetadata
+ * @return Ciphertext
+ */
+PythonCiphertext CiphertextFromArray(PythonContext context, py::array_t<uint64_t, py::array::c_style> limbs,
+                                     py::dict metadata) {
+    Context cc = context.getContext();
+    if (limbs.ndim() != 3)
+        throw std::invalid_argument("Expected an array of shape (elements, limbs, ring_dim).");
+
+    size_t level = metadata["level"].cast<size_t>();
+    size_t noiseScaleDeg = metadata["noise_scale_degree"].cast<size_t>();
+    uint32_t slots = metadata["slots"].cast<uint32_t>();
+
+    auto params = std::make_shared<ILDCRTParams<BigInteger>>(*cc->GetCryptoParameters()->GetElementParams());
+    size_t ringDim = params->GetRingDimension();
+    size_t chain = params->GetParams().size();
+    if (limbs.shape(0) < 2)
+        throw std::invalid_argument("A ciphertext has at least two elements.");
+    if (level >= chain)
+        throw std::invalid_argument("The context has only " + std::to_string(chain) + " RNS limbs.");
+    //  Every level consumed drops one limb, so a ciphertext at a level has the remaining limbs of the chain
+    size_t towers = chain - level;
+    if ((size_t) limbs.shape(1) != towers)
+        throw std::invalid_argument("A ciphertext at level " + std::to_string(level) + " has " +
+                                    std::to_string(towers) + " RNS limbs.");
+    if ((size_t) limbs.shape(2) != ringDim)
+        throw std::invalid_argument("The ring dimension of the context is " + std::to_string(ringDim) + ".");
+    if (noiseScaleDeg == 0)
+        throw std::invalid_argument("The noise scale degree of a ciphertext is at least one.");
+    if (slots == 0 || slots > ringDim / 2)
+        throw std::invalid_argument("The number of slots has to be between 1 and " + std::to_string(ringDim / 2) + ".");
+    while (params->GetParams().size() > towers)
+        params->PopLastParam();
+
+    const uint64_t* in = limbs.data();
+    std::vector<DCRTPoly> elements;
+    for (py::ssize_t i = 0; i < limbs.shape(0); i++) {
+        DCRTPoly element(params, Format::EVALUATION);
+        for (size_t limb = 0; limb < towers; limb++) {
+            NativePoly tower(params->GetParams()[limb], Format::EVALUATION, true);
+            uint64_t modulus = params->GetParams()[limb]->GetModulus().ConvertToInt();
+            for (size_t j = 0; j < ringDim; j++) {
+                if (in[j] >= modulus)
+                    throw std::invalid_argument("Coefficient " + std::to_string(j) + " of RNS limb " +
+                                                std::to_string(limb) + " of element " + std::to_string(i) +
+                                                " is not below the modulus of the limb.");
+            }
+            std::memcpy(&tower[0], in, ringDim * sizeof(uint64_t));
+            element.SetElementAtIndex(limb, std::move(tower));
+            in += ringDim;
+        }
+        elements.push_back(std::move(element));
+    }
+
+    auto cipher = std::make_shared<CiphertextImpl<DCRTPoly>>(cc);
+    cipher->SetElements(std::move(elements));
+    cipher->SetEncodingType(CKKS_PACKED_ENCODING);
+    cipher->SetLevel(level);
+    cipher->SetNoiseScaleDeg(noiseScaleDeg);
+    cipher->SetSlots(slots);
+    cipher->SetScalingFactor(metadata["scaling_factor"].cast<double>());
+    cipher->SetKeyTag(metadata["key_tag"].cast<std::string>());
+
+    PythonCiphertext result;
+    result.setCiphertext(cipher);
+    return result;
+}
+
+#endif //NEURALPY_CIPHERTEXTARRAYS_H
@@ -0,0 +1,417 @@
+/**
+ * @file CiphertextDataset.h
+ *
+ * @brief This file includes a container format that stores many serialized ciphertexts in a single file, so that
+ * encrypted datasets do not need one file per sample. The file consists of a header, the length prefixed ciphertexts
+ * and an offset index at the end. Every serialized ciphertext carries its context, so there is no separate context in
+ * the file. The writer can reopen a file and keep appending to it, the reader memory maps the file and deserializes
+ * ciphertext i directly from the mapped memory.
+ *
+ * Layout:
+ *  magic "NPYCTDS2" | (magic "CTXT" | uint64 size | ciphertext)* | uint64 offsets[n] | uint64 n | uint64 index offset |
+ *  magic "NPYCTIDX"
+ *
+ * If the index is missing, e.g. because a writer was not closed, it is rebuilt by scanning the records.
+ *
+ * Writers hold an exclusive and readers a shared flock on the file, so a dataset can not be truncated or appended to
+ * while it is memory mapped, which would make reads behind the new end of the file fail with SIGBUS.
+ */
+#ifndef NEURALPY_CIPHERTEXTDATASET_H
+#define NEURALPY_CIPHERTEXTDATASET_H
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "OpenFHEPrerequisites.h"
+#include "PythonCiphertext.h"
+#include "PythonContext.h"
+
+
+namespace dataset {
+    const char headerMagic[8] = {'N', 'P', 'Y', 'C', 'T', 'D', 'S', '2'};
+    const char indexMagic[8] = {'N', 'P', 'Y', 'C', 'T', 'I', 'D', 'X'};
+    const char recordMagic[4] = {'C', 'T', 'X', 'T'};
+
+    //  Size of the record header in front of every ciphertext: magic and length
+    const uint64_t recordHeaderSize = sizeof(recordMagic) + sizeof(uint64_t);
+
+    //  Size of the index trailer without the offsets: count, index offset and magic
+    const uint64_t trailerSize = 2 * sizeof(uint64_t) + sizeof(indexMagic);
+
+
+    /***
+     * Read only stream buffer over a block of memory, used to deserialize from the memory map without copying.
+     */
+    class MemoryBuffer : public std::streambuf {
+    public:
+        MemoryBuffer(const char* data, size_t size) {
+            char* begin = const_cast<char*>(data);
+            setg(begin, begin, begin + size);
+        }
+
+    protected:
+        pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode) override {
+            off_type base = direction == std::ios_base::beg ? 0 :
+                            direction == std::ios_base::cur ? gptr() - eback() : egptr() - eback();
+            if (base + offset < 0 || base + offset > egptr() - eback())
+                return pos_type(off_type(-1));
+
+            setg(eback(), eback() + base + offset, egptr());
+            return pos_type(base + offset);
+        }
+
+        pos_type seekpos(pos_type position, std::ios_base::openmode mode) override {
+            return seekoff(off_type(position), std::ios_base::beg, mode);
+        }
+    };
+
+
+    /***
+     * Reads length bytes at the given position of a stream.
+     *
+     * @return False if the stream ends before
+     */
+    bool ReadAt(std::istream& stream, uint64_t position, void* out, uint64_t length) {
+        stream.clear();
+        stream.seekg(position);
+        stream.read(static_cast<char*>(out), length);
+        return static_cast<uint64_t>(stream.gcount()) == length;
+    }
+
+
+    /***
+     * Throws for a failed system call on a dataset file, with the reason given by errno.
+     */
+    [[noreturn]] void ThrowFileError(const std::string& action, const std::string& filePath) {
+        throw std::ios_base::failure("Error " + action + " dataset file " + filePath + ": " + std::strerror(errno));
+    }
+
+
+    /***
+     * Parses the header and the index of a dataset. Only the header and the trailer are read, the records are only
+     * visited if the index is missing.
+     *
+     * @param stream Seekable stream over the file
+     * @param size Size of the file
+     * @param offsets Offsets of the records of all ciphertexts
+     * @return Offset behind the last complete ciphertext, where new ciphertexts are appended
+     */
+    uint64_t ParseDataset(std::istream& stream, uint64_t size, std::vector<uint64_t>& offsets) {
+        char magic[sizeof(headerMagic)];
+        if (size < sizeof(headerMagic) || !ReadAt(stream, 0, magic, sizeof(magic)) ||
+                std::memcmp(magic, headerMagic, sizeof(headerMagic)) != 0)
+            throw std::runtime_error("File is not a ciphertext dataset.");
+
+        uint64_t dataBegin = sizeof(headerMagic);
+
+        offsets.clear();
+
+        struct { uint64_t count; uint64_t indexOffset; char magic[sizeof(indexMagic)]; } trailer;
+        static_assert(sizeof(trailer) == trailerSize, "Unexpected padding in the dataset trailer.");
+        if (size >= dataBegin + trailerSize && ReadAt(stream, size - trailerSize, &trailer, trailerSize) &&
+                std::memcmp(trailer.magic, indexMagic, sizeof(indexMagic)) == 0) {
+            uint64_t indexOffset = trailer.indexOffset;
+            if (indexOffset >= dataBegin && indexOffset <= size - trailerSize &&
+                    trailer.count == (size - trailerSize - indexOffset) / sizeof(uint64_t) &&
+                    indexOffset + trailer.count * sizeof(uint64_t) + trailerSize == size) {
+                offsets.resize(trailer.count);
+                if (ReadAt(stream, indexOffset, offsets.data(), trailer.count * sizeof(uint64_t)))
+                    return indexOffset;
+                offsets.clear();
+            }
+        }
+
+        //  No valid index, recover it from the records and drop an incomplete last ciphertext
+        uint64_t position = dataBegin;
+        char record[recordHeaderSize];
+        while (position + recordHeaderSize <= size && ReadAt(stream, position, record, recordHeaderSize) &&
+                std::memcmp(record, recordMagic, sizeof(recordMagic)) == 0) {
+            uint64_t length;
+            std::memcpy(&length, record + sizeof(recordMagic), sizeof(uint64_t));
+            if (length > size - position - recordHeaderSize)
+                break;
+
+            offsets.push_back(position);
+            position += recordHeaderSize + length;
+        }
+
+        return position;
+    }
+
+
+    /***
+     * Takes a flock on an open file without waiting.
+     *
+     * @param fd File descriptor
+     * @param exclusive Whether an exclusive lock is taken for writing, otherwise a shared lock for reading
+     */
+    void LockDataset(int fd, const std::string& filePath, bool exclusive) {
+        if (flock(fd, (exclusive ? LOCK_EX : LOCK_SH) | LOCK_NB) == 0)
+            return;
+
+        ::close(fd);
+        throw std::runtime_error("Dataset file " + filePath + (exclusive ? " is open in a reader or another writer." :
+                                                               " is being written."));
+    }
+}
+
+
+/***
+ * Writes ciphertexts one after another into a dataset file. Ciphertexts are written as soon as they are appended, the
+ * index is written when the writer is closed.
+ */
+class CiphertextDatasetWriter {
+public:
+    /***
+     * Opens a dataset for writing. Fails if the dataset is open in a reader or another writer, as replacing or
+     * appending to it would change a file that is memory mapped.
+     *
+     * @param filePath Path of the dataset
+     * @param append Whether ciphertexts are appended to an existing dataset instead of replacing it
+     */
+    CiphertextDatasetWriter(std::string filePath, bool append=false) : filePath(filePath) {
+        lock = ::open(filePath.c_str(), O_RDWR | O_CREAT, 0644);
+        if (lock < 0)
+            dataset::ThrowFileError("opening", filePath);
+        dataset::LockDataset(lock, filePath, true);
+
+        try {
+            uint64_t size = std::filesystem::file_size(filePath);
+            if (append && size > 0) {
+                std::ifstream existing(filePath, std::ios::in | std::ios::binary);
+                position = dataset::ParseDataset(existing, size, offsets);
+            }
+
+            //  Drops the index, it is rewritten behind the appended ciphertexts on close
+            if (ftruncate(lock, position) != 0)
+                dataset::ThrowFileError("truncating", filePath);
+
+            file.open(filePath, std::ios::out | std::ios::binary | std::ios::app);
+            if (!file.is_open())
+                dataset::ThrowFileError("opening", filePath);
+
+            if (position == 0) {
+                file.write(dataset::headerMagic, sizeof(dataset::headerMagic));
+                position = sizeof(dataset::headerMagic);
+            }
+        } catch (...) {
+            ::close(lock);
+            throw;
+        }
+    }
+
+    ~CiphertextDatasetWriter() {
+        try {
+            close();
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+        }
+    }
+
+    CiphertextDatasetWriter(const CiphertextDatasetWriter&) = delete;
+    CiphertextDatasetWriter& operator=(const CiphertextDatasetWriter&) = delete;
+
+    /***
+     * Appends a ciphertext to the dataset.
+     *
+     * @param ciphertext
+     */
+    void append(PythonCiphertext ciphertext) {
+        if (!file.is_open())
+            throw std::logic_error("Dataset writer has already been closed.");
+
+        std::stringstream stream;
+        Serial::Serialize(ciphertext.getCiphertext(), stream, SerType::BINARY);
+        std::string bytes = stream.str();
+        uint64_t length = bytes.size();
+
+        file.write(dataset::recordMagic, sizeof(dataset::recordMagic));
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(bytes.data(), length);
+        if (!file)
+            dataset::ThrowFileError("writing", filePath);
+
+        offsets.push_back(position);
+        position += dataset::recordHeaderSize + length;
+    }
+
+    /***
+     * Writes the index and closes the file.
+     */
+    void close() {
+        if (!file.is_open())
+            return;
+
+        uint64_t count = offsets.size();
+        file.write(reinterpret_cast<const char*>(offsets.data()), count * sizeof(uint64_t));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        file.write(reinterpret_cast<const char*>(&position), sizeof(position));
+        file.write(dataset::indexMagic, sizeof(dataset::indexMagic));
+        file.close();
+        ::close(lock);
+
+        if (!file)
+            dataset::ThrowFileError("writing", filePath);
+        std::cout << "Dataset with " << count << " ciphertexts written to " << filePath << "." << std::endl;
+    }
+
+    /***
+     * Number of ciphertexts in the dataset.
+     *
+     * @return Number of ciphertexts
+     */
+    size_t size() {
+        return offsets.size();
+    }
+
+private:
+    std::string filePath;
+    std::ofstream file;
+    int lock = -1;
+    uint64_t position = 0;
+    std::vector<uint64_t> offsets;
+};
+
+
+/***
+ * Random access to the ciphertexts of a dataset through a memory map of the file.
+ */
+class CiphertextDatasetReader {
+public:
+    /***
+     * Memory maps a dataset. The file stays locked against writers until the reader is destroyed.
+     *
+     * @param filePath Path of the dataset
+     */
+    CiphertextDatasetReader(std::string filePath) {
+        fd = ::open(filePath.c_str(), O_RDONLY);
+        if (fd < 0)
+            dataset::ThrowFileError("opening", filePath);
+        dataset::LockDataset(fd, filePath, false);
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            dataset::ThrowFileError("opening", filePath);
+        }
+
+        mappedSize = info.st_size;
+        if (mappedSize == 0) {
+            ::close(fd);
+            throw std::runtime_error("Dataset file " + filePath + " is empty.");
+        }
+
+        void* mapping = mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            dataset::ThrowFileError("mapping", filePath);
+        }
+        data = static_cast<const char*>(mapping);
+
+        try {
+            dataset::MemoryBuffer buffer(data, mappedSize);
+            std::istream stream(&buffer);
+            dataset::ParseDataset(stream, mappedSize, offsets);
+        } catch (...) {
+            munmap(const_cast<char*>(data), mappedSize);
+            ::close(fd);
+            throw;
+        }
+    }
+
+    ~CiphertextDatasetReader() {
+        munmap(const_cast<char*>(data), mappedSize);
+        ::close(fd);
+    }
+
+    CiphertextDatasetReader(const CiphertextDatasetReader&) = delete;
+    CiphertextDatasetReader& operator=(const CiphertextDatasetReader&) = delete;
+
+    /***
+     * Number of ciphertexts in the dataset.
+     *
+     * @return Number of ciphertexts
+     */
+    size_t size() {
+        return offsets.size();
+    }
+
+    /***
+     * Context of the dataset, taken from its first ciphertext since every serialized ciphertext carries its context.
+     *
+     * @return Context object
+     */
+    PythonContext getContext() {
+        if (offsets.empty())
+            throw std::logic_error("Dataset does not contain a ciphertext to take the context from.");
+
+        PythonContext result;
+        result.SetContext(get(0).getCiphertext()->GetCryptoContext());
+        return result;
+    }
+
+    /***
+     * Deserializes the ciphertext at the given index directly from the memory map.
+     *
+     * @param index Index of the ciphertext
+     * @return Ciphertext
+     */
+    PythonCiphertext get(size_t index) {
+        if (index >= offsets.size())
+            throw std::out_of_range("Ciphertext index out of range.");
+
+        uint64_t offset = offsets[index];
+        if (offset > mappedSize - dataset::recordHeaderSize ||
+                std::memcmp(data + offset, dataset::recordMagic, sizeof(dataset::recordMagic)) != 0)
+            throw std::runtime_error("Index of ciphertext " + std::to_string(index) + " does not point to a record.");
+
+        uint64_t length;
+        std::memcpy(&length, data + offset + sizeof(dataset::recordMagic), sizeof(length));
+        if (length > mappedSize - offset - dataset::recordHeaderSize)
+            throw std::runtime_error("Ciphertext " + std::to_string(index) + " exceeds the dataset file.");
+
+        dataset::MemoryBuffer buffer(data + offset + dataset::recordHeaderSize, length);
+        std::istream stream(&buffer);
+
+        Cipher cipher;
+        Serial::Deserialize(cipher, stream, SerType::BINARY);
+
+        PythonCiphertext result;
+        result.setCiphertext(cipher);
+        return result;
+    }
+
+    /***
+     * Deserializes count consecutive ciphertexts, fewer if the end of the dataset is reached.
+     *
+     * @param start Index of the first ciphertext
+     * @param count Number of ciphertexts
+     * @return Ciphertexts
+     */
+    std::vector<PythonCiphertext> getBatch(size_t start, size_t count) {
+        std::vector<PythonCiphertext> batch;
+        for (size_t i = start; i < std::min(start + count, offsets.size()); i++)
+            batch.push_back(get(i));
+
+        return batch;
+    }
+
+private:
+    int fd = -1;
+    const char* data = nullptr;
+    uint64_t mappedSize = 0;
+    std::vector<uint64_t> offsets;
+};
+
+#endif //NEURALPY_CIPHERTEXTDATASET_H
@@ -0,0 +1,276 @@
+/**
+ * @file ContextBinding.h
+ *
+ * @brief This file includes the bookkeeping needed to evaluate operators under a context other than the global one set
+ * by SetContext. The NeuralOFHE operators read a single global context, which is guarded by a reader writer lock that
+ * prefers writers, so a switch to another context is not starved by a steady stream of operators under the current one.
+ * Operators evaluated under the context the global one already points to share the lock and run concurrently, while an
+ * operator bound to another context holds the lock exclusively and swaps the global context for the duration of its
+ * forward call. Operators that only use the context of their input ciphertext are marked as ContextFree and never take
+ * the lock.
+ *
+ * As there is only one global context, only one context is active at a time. Operators bound to different contexts
+ * take turns instead of running in parallel, only operators under the same context or context free ones overlap. The
+ * GIL is released while waiting for the lock, so a Python defined operator holding it can still run.
+ */
+#ifndef NEURALPY_CONTEXTBINDING_H
+#define NEURALPY_CONTEXTBINDING_H
+
+#include <condition_variable>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+
+#include <pybind11/pybind11.h>
+
+#include "NeuralOFHE/NeuralOFHE.h"
+
+#include "OpenFHEPrerequisites.h"
+#include "ThreadBudget.h"
+
+
+/***
+ * Marker for operators that evaluate everything with the context of their input ciphertext and do not depend on the
+ * global NeuralOFHE context.
+ */
+class ContextFree {
+public:
+    virtual ~ContextFree() = default;
+};
+
+
+namespace binding {
+    /***
+     * Reader writer lock that lets no new reader in while a writer is waiting. The std::shared_mutex of glibc prefers
+     * readers, which lets operators under the current context keep a context switch waiting indefinitely.
+     */
+    class WriterPreferringMutex {
+    public:
+        void lock() {
+            std::unique_lock<std::mutex> guard(mutex);
+            waitingWriters++;
+            changed.wait(guard, [this]() { return !writer && readers == 0; });
+            waitingWriters--;
+            writer = true;
+        }
+
+        void unlock() {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                writer = false;
+            }
+            changed.notify_all();
+        }
+
+        void lock_shared() {
+            std::unique_lock<std::mutex> guard(mutex);
+            changed.wait(guard, [this]() { return !writer && waitingWriters == 0; });
+            readers++;
+        }
+
+        void unlock_shared() {
+            bool last;
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                last = --readers == 0;
+            }
+            if (last)
+                changed.notify_all();
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable changed;
+        uint32_t readers = 0;
+        uint32_t waitingWriters = 0;
+        bool writer = false;
+    };
+
+    /***
+     * Lock guarding the global NeuralOFHE context.
+     */
+    WriterPreferringMutex& ContextMutex() {
+        static WriterPreferringMutex mutex;
+        return mutex;
+    }
+
+    /***
+     * The context set by SetContext, which is used by every operator that is not bound to a context.
+     */
+    Context& DefaultContext() {
+        static Context context;
+        return context;
+    }
+
+    /***
+     * The context the global NeuralOFHE context currently points to.
+     */
+    Context& CurrentContext() {
+        static Context context;
+        return context;
+    }
+
+    /***
+     * Number of ScopedContext objects alive on the calling thread. Python defined operators may call other operators
+     * from within their forward function, in which case the lock is already held.
+     */
+    uint32_t& LockDepth() {
+        static thread_local uint32_t depth = 0;
+        return depth;
+    }
+
+    /***
+     * Whether the calling thread holds the lock exclusively.
+     */
+    bool& HoldsExclusive() {
+        static thread_local bool exclusive = false;
+        return exclusive;
+    }
+
+    /***
+     * Takes a lock, releasing the GIL while waiting if the calling thread holds it. Otherwise a thread holding the lock
+     * and waiting for the GIL, e.g. to run a Python defined operator, would never get it.
+     *
+     * @param lock Unlocked lock
+     */
+    template<typename Lock>
+    void LockWithoutGIL(Lock& lock) {
+        if (!Py_IsInitialized() || !PyGILState_Check()) {
+            lock.lock();
+            return;
+        }
+
+        pybind11::gil_scoped_release release;
+        lock.lock();
+    }
+}
+
+
+/***
+ * Sets the context used by all operators that are not bound to a context.
+ *
+ * @param context
+ */
+void SetDefaultContext(Context context) {
+    if (binding::LockDepth() > 0)
+        throw std::logic_error("The context can not be changed from within an operator.");
+
+    std::unique_lock<binding::WriterPreferringMutex> lock(binding::ContextMutex(), std::defer_lock);
+    binding::LockWithoutGIL(lock);
+
+    binding::DefaultContext() = context;
+    binding::CurrentContext() = context;
+    SetContext(context);
+}
+
+
+/***
+ * Holds the lock on the global NeuralOFHE context and points it to the given context for the lifetime of the object.
+ */
+class ScopedContext {
+public:
+    /***
+     * @param bound Context to use, the default context if empty
+     */
+    explicit ScopedContext(Context bound) : outermost(binding::LockDepth() == 0) {
+        if (outermost) {
+            sharedLock = std::shared_lock<binding::WriterPreferringMutex>(binding::ContextMutex(), std::defer_lock);
+            binding::LockWithoutGIL(sharedLock);
+            if (needsSwitch(bound)) {
+                sharedLock.unlock();
+                exclusiveLock = std::unique_lock<binding::WriterPreferringMutex>(binding::ContextMutex(),
+                                                                                 std::defer_lock);
+                binding::LockWithoutGIL(exclusiveLock);
+                binding::HoldsExclusive() = true;
+            }
+        } else if (needsSwitch(bound) && !binding::HoldsExclusive()) {
+            throw std::logic_error("An operator bound to another context can not be called from within an operator.");
+        }
+        binding::LockDepth()++;
+
+        previous = binding::CurrentContext();
+        if (needsSwitch(bound)) {
+            Context target = bound ? bound : binding::DefaultContext();
+            SetContext(target);
+            binding::CurrentContext() = target;
+        }
+    }
+
+    ~ScopedContext() {
+        if (binding::CurrentContext() != previous) {
+            SetContext(previous);
+            binding::CurrentContext() = previous;
+        }
+
+        binding::LockDepth()--;
+        if (outermost)
+            binding::HoldsExclusive() = false;
+    }
+
+    ScopedContext(const ScopedContext&) = delete;
+    ScopedContext& operator=(const ScopedContext&) = delete;
+
+private:
+    static bool needsSwitch(const Context& bound) {
+        Context target = bound ? bound : binding::DefaultContext();
+        return target && target != binding::CurrentContext();
+    }
+
+    bool outermost;
+    std::shared_lock<binding::WriterPreferringMutex> sharedLock;
+    std::unique_lock<binding::WriterPreferringMutex> exclusiveLock;
+    Context previous;
+};
+
+
+/***
+ * Applies the forward function of an operator under the given context and the thread budget of the calling thread.
+ *
+ * @param op Operator
+ * @param x Input ciphertext
+ * @param bound Context to use, the default context if empty
+ * @return Output ciphertext
+ */
+Cipher ForwardInContext(Operator& op, Cipher x, Context bound=nullptr) {
+    ApplyThreadBudget();
+    if (dynamic_cast<ContextFree*>(&op))
+        return op.forward(std::move(x));
+
+    ScopedContext scope(bound);
+    return op.forward(std::move(x));
+}
+
+
+/***
+ * Operator evaluating another operator under a fixed context, so single operators can be bound like a Sequential. It
+ * takes the lock itself and is therefore context free for the pipeline it is used in.
+ */
+class BoundOperator : public Operator, public ContextFree {
+public:
+    /***
+     * @param op Operator to evaluate
+     * @param context Context the operator is evaluated under
+     */
+    BoundOperator(std::shared_ptr<Operator> op, Context context)
+            : Operator(instances, "Bound" + op->getName()), op(std::move(op)), context(std::move(context)) {}
+
+    Cipher forward(Cipher x) override {
+        return ForwardInContext(*op, std::move(x), context);
+    }
+
+    std::shared_ptr<Operator> GetOperator() {
+        return op;
+    }
+
+    Context GetContext() {
+        return context;
+    }
+
+private:
+    static inline uint32_t instances = 0;
+
+    std::shared_ptr<Operator> op;
+    Context context;
+};
+
+#endif //NEURALPY_CONTEXTBINDING_H
@@ -0,0 +1,201 @@
+/**
+ * @file MemoryAccounting.h
+ *
+ * @brief This file includes functions measuring the memory used by OpenFHE objects and by the process. The serialized
+ * size is the exact number of bytes the binary serialization writes, the memory size counts the coefficients of all
+ * polynomials of an object, which dominate its footprint, without the small metadata and allocator overhead. Resident
+ * memory is read from /proc and is only available on Linux.
+ */
+#ifndef NEURALPY_MEMORYACCOUNTING_H
+#define NEURALPY_MEMORYACCOUNTING_H
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "OpenFHEPrerequisites.h"
+
+
+namespace memory {
+    /***
+     * Stream buffer discarding everything written to it while counting the bytes.
+     */
+    class CountingBuffer : public std::streambuf {
+    public:
+        uint64_t count = 0;
+
+    protected:
+        int_type overflow(int_type c) override {
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+                count++;
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char*, std::streamsize n) override {
+            count += n;
+            return n;
+        }
+    };
+
+    /***
+     * Reads a field of /proc/self/status given in kB.
+     *
+     * @param field Name of the field, e.g. VmRSS
+     * @return Value in bytes, zero if not available
+     */
+    uint64_t ReadStatus(const std::string& field) {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, field.size() + 1, field + ":") != 0)
+                continue;
+
+            std::istringstream values(line.substr(field.size() + 1));
+            uint64_t kilobytes = 0;
+            values >> kilobytes;
+            return kilobytes * 1024;
+        }
+
+        return 0;
+    }
+}
+
+
+/***
+ * Number of bytes the binary serialization of an object takes, without writing it anywhere.
+ *
+ * @tparam T Serializable OpenFHE type
+ * @param object
+ * @return Size in bytes
+ */
+template<typename T>
+uint64_t GetSerializedSize(const T& object) {
+    memory::CountingBuffer buffer;
+    std::ostream stream(&buffer);
+    Serial::Serialize(object, stream, SerType::BINARY);
+
+    return buffer.count;
+}
+
+
+/***
+ * Size of the coefficients of a polynomial in memory.
+ *
+ * @param polynomial
+ * @return Size in bytes
+ */
+uint64_t GetMemorySize(const DCRTPoly& polynomial) {
+    return static_cast<uint64_t>(polynomial.GetNumOfElements()) * polynomial.GetRingDimension() * sizeof(uint64_t);
+}
+
+
+uint64_t GetMemorySize(const std::vector<DCRTPoly>& polynomials) {
+    uint64_t bytes = 0;
+    for (auto& polynomial : polynomials)
+        bytes += GetMemorySize(polynomial);
+
+    return bytes;
+}
+
+
+uint64_t GetMemorySize(const Cipher& ciphertext) {
+    return ciphertext ? GetMemorySize(ciphertext->GetElements()) : 0;
+}
+
+
+uint64_t GetMemorySize(const EvalKey<DCRTPoly>& key) {
+    return GetMemorySize(key->GetAVector()) + GetMemorySize(key->GetBVector());
+}
+
+
+/***
+ * Serialized size, memory size and number of the relinearization keys generated for a context.
+ *
+ * @param context
+ * @return Map with the keys serialized, memory and count
+ */
+std::map<std::string, uint64_t> GetMultKeyUsage(const Context& context) {
+    uint64_t bytes = 0;
+    uint64_t count = 0;
+    for (auto& entry : CryptoContextImpl<DCRTPoly>::GetAllEvalMultKeys()) {
+        for (auto& key : entry.second) {
+            if (key->GetCryptoContext() != context)
+                continue;
+
+            bytes += GetMemorySize(key);
+            count++;
+        }
+    }
+
+    memory::CountingBuffer buffer;
+    std::ostream stream(&buffer);
+    CryptoContextImpl<DCRTPoly>::SerializeEvalMultKey(stream, SerType::BINARY, context);
+
+    return {{"serialized", buffer.count}, {"memory", bytes}, {"count", count}};
+}
+
+
+/***
+ * Serialized size, memory size and number of the rotation keys generated for a context.
+ *
+ * @param context
+ * @return Map with the keys serialized, memory and count
+ */
+std::map<std::string, uint64_t> GetRotationKeyUsage(const Context& context) {
+    uint64_t bytes = 0;
+    uint64_t count = 0;
+    for (auto& entry : CryptoContextImpl<DCRTPoly>::GetAllEvalAutomorphismKeys()) {
+        for (auto& key : *entry.second) {
+            if (key.second->GetCryptoContext() != context)
+                continue;
+
+            bytes += GetMemorySize(key.second);
+            count++;
+        }
+    }
+
+    memory::CountingBuffer buffer;
+    std::ostream stream(&buffer);
+    CryptoContextImpl<DCRTPoly>::SerializeEvalAutomorphismKey(stream, SerType::BINARY, context);
+
+    return {{"serialized", buffer.count}, {"memory", bytes}, {"count", count}};
+}
+
+
+/***
+ * Current resident memory of the process.
+ *
+ * @return Size in bytes, zero if not available
+ */
+uint64_t GetResidentMemory() {
+    return memory::ReadStatus("VmRSS");
+}
+
+
+/***
+ * Peak resident memory of the process since it started or since the last call to ResetPeakResidentMemory.
+ *
+ * @return Size in bytes, zero if not available
+ */
+uint64_t GetPeakResidentMemory() {
+    return memory::ReadStatus("VmHWM");
+}
+
+
+/***
+ * Resets the peak resident memory to the current resident memory, so the peak of a single step can be measured.
+ *
+ * @return False if the kernel does not support resetting the peak
+ */
+bool ResetPeakResidentMemory() {
+    std::ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+    clear.flush();
+
+    return clear.good();
+}
+
+#endif //NEURALPY_MEMORYACCOUNTING_H
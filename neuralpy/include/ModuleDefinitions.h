@@ -9,6 +9,11 @@
 
 #include "../include/WrapperClasses.h"
 #include "WrapperFunctions.h"
+#include "CiphertextArrays.h"
+#include "CiphertextDataset.h"
+#include "Sequential.h"
+#include "AsyncExecution.h"
+#include "ThreadConfiguration.h"
 
 namespace py = pybind11;
 
@@ -25,13 +30,32 @@ std::function<PythonCiphertext (T&, PythonCiphertext)> initForward() {
             Ciphertext<DCRTPoly> input = x.getCiphertext();
             PythonCiphertext result;
 
-            result.setCiphertext(self.forward(input));
+            result.setCiphertext(ForwardInContext(self, input));
 
             return result;
     };
 }
 
 
+/***
+ * Returns the asynchronous forward function as a C++ lambda. The operator runs on the TaskScheduler and the lambda
+ * returns an awaitable for the output.
+ *
+ * @tparam T Class of the Operation
+ * @return Lambda submitting the forward function.
+ */
+template<typename T>
+std::function<py::object (std::shared_ptr<T>, PythonCiphertext)> initForwardAsync() {
+    return [](std::shared_ptr<T> self, PythonCiphertext x) -> py::object {
+            return AsAwaitable(SubmitPython([self, x]() mutable -> PythonCiphertext {
+                PythonCiphertext result;
+                result.setCiphertext(ForwardInContext(*self, x.takeCiphertext()));
+                return result;
+            }));
+    };
+}
+
+
 /***
  * Defines all enums, OpenFHE uses for setting CKKS parameters.
  */
@@ -73,6 +97,14 @@ void defineEnums (py::module_& m) {
             .value("BV", BV)
             .value("HYBRID", HYBRID)
             .export_values();
+
+    py::enum_<ApproximationMode>(m, "ApproximationMode")
+            .value("CHEBYSHEV", ApproximationMode::CHEBYSHEV)
+            .value("PATERSON_STOCKMEYER", ApproximationMode::PATERSON_STOCKMEYER)
+            .value("CHEBYSHEV_LINEAR", ApproximationMode::CHEBYSHEV_LINEAR)
+            .value("COMPOSITE", ApproximationMode::COMPOSITE)
+            .value("SQUARE", ApproximationMode::SQUARE)
+            .export_values();
 }
 
 
@@ -95,12 +127,16 @@ void defineBasicOpenFHEModules (py::module_& m) {
     py::class_<PythonKey<PublicKey<DCRTPoly>>>(m, "PublicKey")
             .def(py::init<>())
             .def("load", &PythonKey<PublicKey<DCRTPoly>>::load, py::arg("filePath"))
-            .def("save", &PythonKey<PublicKey<DCRTPoly>>::save, py::arg("filePath"));
+            .def("save", &PythonKey<PublicKey<DCRTPoly>>::save, py::arg("filePath"))
+            .def("getSerializedSize", &PythonKey<PublicKey<DCRTPoly>>::getSerializedSize)
+            .def("getMemorySize", &PythonKey<PublicKey<DCRTPoly>>::getMemorySize);
 
     py::class_<PythonKey<PrivateKey<DCRTPoly>>>(m, "PrivateKey")
             .def(py::init<>())
             .def("load", &PythonKey<PrivateKey<DCRTPoly>>::load, py::arg("filePath"))
-            .def("save", &PythonKey<PrivateKey<DCRTPoly>>::save, py::arg("filePath"));
+            .def("save", &PythonKey<PrivateKey<DCRTPoly>>::save, py::arg("filePath"))
+            .def("getSerializedSize", &PythonKey<PrivateKey<DCRTPoly>>::getSerializedSize)
+            .def("getMemorySize", &PythonKey<PrivateKey<DCRTPoly>>::getMemorySize);
 
     py::class_<PythonKeypair>(m, "KeyPair")
             .def(py::init<>())
@@ -109,15 +145,47 @@ void defineBasicOpenFHEModules (py::module_& m) {
 
     py::class_<PythonCiphertext>(m, "Ciphertext")
             .def(py::init<>())
-            .def("save", &PythonCiphertext::save, py::arg("filePath"))
+            .def("save", &PythonCiphertext::save,
+                 "Serialize the ciphertext, optionally compacting it first. Returns the number of bytes saved.",
+                 py::arg("filePath"),
+                 py::arg("compress")=false,
+                 py::arg("towers")=1)
             .def("load", &PythonCiphertext::load, py::arg("filePath"))
+            .def("compact", &PythonCiphertext::compact,
+                 "Drop all but the given number of RNS limbs. Returns the number of bytes saved.",
+                 py::arg("towers")=1)
+            .def("getTowers", &PythonCiphertext::getTowers)
+            .def("getLevel", &PythonCiphertext::getLevel)
+            .def("getSerializedSize", &PythonCiphertext::getSerializedSize,
+                 "Number of bytes the binary serialization of the ciphertext takes.")
+            .def("getMemorySize", &PythonCiphertext::getMemorySize,
+                 "Size of the RNS limbs of the ciphertext in memory.")
+            .def("getLimbView", &GetLimbView,
+                 "NumPy view of an RNS limb of a ciphertext element without copying. The view shares the ciphertext, "
+                 "so the next in place operation or writable view copies it first and every earlier writable view is "
+                 "detached from it, writes through a detached view are lost. Take a writable view right before "
+                 "writing and do not keep it across other operations.",
+                 py::arg("element"),
+                 py::arg("limb"),
+                 py::arg("writable")=false)
+            .def("toArray", &CiphertextToArray,
+                 "Copy the RNS limbs into a uint64 array of shape (elements, limbs, ring_dim).")
+            .def("getMetadata", &GetCiphertextMetadata,
+                 "Metadata needed to rebuild the ciphertext with fromArray.")
+            .def_static("fromArray", &CiphertextFromArray,
+                        "Rebuild a ciphertext from an array returned by toArray and its metadata.",
+                        py::arg("context"),
+                        py::arg("limbs"),
+                        py::arg("metadata"))
             .def("setSlots", &PythonCiphertext::setSlots, py::arg("slots"))
             .def("getSlots", &PythonCiphertext::getSlots);
 
     py::class_<PythonPlaintext>(m, "Plaintext")
             .def(py::init<>())
             .def("GetPackedValue", &PythonPlaintext::GetPackedValue)
-            .def("SetLength", &PythonPlaintext::SetLength, py::arg("length"));
+            .def("SetLength", &PythonPlaintext::SetLength, py::arg("length"))
+            .def("GetSerializedSize", &PythonPlaintext::GetSerializedSize)
+            .def("GetMemorySize", &PythonPlaintext::GetMemorySize);
 
     py::class_<PythonContext>(m, "Context")
             .def(py::init<>())
@@ -130,19 +198,25 @@ void defineBasicOpenFHEModules (py::module_& m) {
                  "Getter function for the ring dimension.")
             .def("Encrypt", &PythonContext::Encrypt,
                  "Encrypt an OpenFHE plaintext.",
+                 py::call_guard<py::gil_scoped_release>(),
                  py::arg("plaintext"),
                  py::arg("publicKey"))
             .def("PackPlaintext", &PythonContext::PackPlaintext,
-                 "Pack a Python iterator into an OpenFHE plaintext.",
-                 py::arg("plaintext"))
+                 "Pack a Python iterator into an OpenFHE plaintext at the given level.",
+                 py::call_guard<py::gil_scoped_release>(),
+                 py::arg("plaintext"),
+                 py::arg("level")=0)
             .def("Decrypt", &PythonContext::Decrypt,
                  "Decrypt a ciphertext into an OpenFHE plaintext.",
+                 py::call_guard<py::gil_scoped_release>(),
                  py::arg("ciphertext"),
                  py::arg("privateKey"))
             .def("EvalMultKeyGen", &PythonContext::EvalMultKeyGen,
                  py::arg("privateKey"))
             .def("GenRotateKeys", &PythonContext::GenRotations,
-                 "Generate rotation keys for doing matrix multiplication with the given batch size.")
+                 "Generate rotation keys for doing matrix multiplication with the given batch size.",
+                 py::arg("privateKey"),
+                 py::arg("indices")=std::vector<int32_t>())
             .def("save", &PythonContext::save,
                  "Serialize the context to a file.",
                  py::arg("filePath"))
@@ -161,44 +235,265 @@ void defineBasicOpenFHEModules (py::module_& m) {
             .def("loadRotKeys", &PythonContext::loadRotKeys,
                  "Read rotation keys from a file into the context object.",
                  py::arg("filePath"))
-            .def("EvalAdd", py::overload_cast<PythonCiphertext, PythonCiphertext>(&PythonContext::EvalAdd),
+            .def("GetMultKeyUsage", &PythonContext::GetMultKeyUsage,
+                 "Serialized size, memory size and number of the multiplication keys.")
+            .def("GetRotationKeyUsage", &PythonContext::GetRotationKeyUsage,
+                 "Serialized size, memory size and number of the rotation keys.")
+            .def("EvalAdd", py::overload_cast<const PythonCiphertext&, const PythonCiphertext&>(
+                    &PythonContext::EvalAdd),
                     "Addition of two ciphertexts a and b.",
                     py::arg("a"),
                     py::arg("b"))
-            .def("EvalAdd", py::overload_cast<std::vector<double>, PythonCiphertext>(&PythonContext::EvalAdd),
+            .def("EvalAdd", py::overload_cast<const std::vector<double>&, const PythonCiphertext&>(
+                    &PythonContext::EvalAdd),
                     "Addition of a plaintext a with a ciphertext b",
                     py::arg("a"),
                     py::arg("b"))
-            .def("EvalAdd", py::overload_cast<double, PythonCiphertext>(&PythonContext::EvalAdd),
+            .def("EvalAdd", py::overload_cast<double, const PythonCiphertext&>(&PythonContext::EvalAdd),
                     "Addition of a floating point number a with a ciphertext b",
                     py::arg("a"),
                     py::arg("b"))
-            .def("EvalMult", py::overload_cast<PythonCiphertext, PythonCiphertext>(&PythonContext::EvalMult),
+            .def("EvalMult", py::overload_cast<const PythonCiphertext&, const PythonCiphertext&>(
+                    &PythonContext::EvalMult),
                     "Multiplication of two ciphertexts.",
                     py::arg("a"),
                     py::arg("b"))
-            .def("EvalMult", py::overload_cast<std::vector<double>, PythonCiphertext>(&PythonContext::EvalMult),
+            .def("EvalMult", py::overload_cast<const std::vector<double>&, const PythonCiphertext&>(
+                    &PythonContext::EvalMult),
                     "Multiplication of a plaintext a with a ciphertext b",
                     py::arg("a"),
                     py::arg("b"))
-            .def("EvalMult", py::overload_cast<double, PythonCiphertext>(&PythonContext::EvalMult),
+            .def("EvalMult", py::overload_cast<double, const PythonCiphertext&>(&PythonContext::EvalMult),
                     "Multiplication of a floating point number a with a ciphertext b",
                     py::arg("a"),
                     py::arg("b"))
-            .def("EvalSub", py::overload_cast<PythonCiphertext, PythonCiphertext>(&PythonContext::EvalSub),
+            .def("EvalSub", py::overload_cast<const PythonCiphertext&, const PythonCiphertext&>(
+                    &PythonContext::EvalSub),
                     "Subtraction of ciphertext b from ciphertext a.",
                     py::arg("a"),
                     py::arg("b"))
-            .def("EvalSub", py::overload_cast<std::vector<double>, PythonCiphertext, bool>(&PythonContext::EvalSub),
+            .def("EvalSub", py::overload_cast<const std::vector<double>&, const PythonCiphertext&, bool>(
+                    &PythonContext::EvalSub),
                     "Subtraction of ciphertext b from plaintext a, dependant on the reverse variable.",
                     py::arg("a"),
                     py::arg("b"),
                     py::arg("reverse")=false)
-            .def("EvalSub", py::overload_cast<double, PythonCiphertext, bool>(&PythonContext::EvalSub),
+            .def("EvalSub", py::overload_cast<double, const PythonCiphertext&, bool>(&PythonContext::EvalSub),
                     "Subtraction of ciphertext b from floating point number a, dependant on the reverse variable.",
                     py::arg("a"),
                     py::arg("b"),
-                    py::arg("reverse")=false);
+                    py::arg("reverse")=false)
+            .def("EvalAddInPlace", py::overload_cast<PythonCiphertext&, const PythonCiphertext&>(
+                    &PythonContext::EvalAddInPlace),
+                    "In place addition of ciphertext b to ciphertext a.",
+                    py::arg("a"),
+                    py::arg("b"))
+            .def("EvalAddInPlace", py::overload_cast<PythonCiphertext&, const std::vector<double>&>(
+                    &PythonContext::EvalAddInPlace),
+                    "In place addition of plaintext b to ciphertext a.",
+                    py::arg("a"),
+                    py::arg("b"))
+            .def("EvalAddInPlace", py::overload_cast<PythonCiphertext&, double>(&PythonContext::EvalAddInPlace),
+                    "In place addition of floating point number b to ciphertext a.",
+                    py::arg("a"),
+                    py::arg("b"))
+            .def("EvalSubInPlace", py::overload_cast<PythonCiphertext&, const PythonCiphertext&>(
+                    &PythonContext::EvalSubInPlace),
+                    "In place subtraction of ciphertext b from ciphertext a.",
+                    py::arg("a"),
+                    py::arg("b"))
+            .def("EvalSubInPlace", py::overload_cast<PythonCiphertext&, const std::vector<double>&>(
+                    &PythonContext::EvalSubInPlace),
+                    "In place subtraction of plaintext b from ciphertext a.",
+                    py::arg("a"),
+                    py::arg("b"))
+            .def("EvalSubInPlace", py::overload_cast<PythonCiphertext&, double>(&PythonContext::EvalSubInPlace),
+                    "In place subtraction of floating point number b from ciphertext a.",
+                    py::arg("a"),
+                    py::arg("b"))
+            .def("EvalMultInPlace", py::overload_cast<PythonCiphertext&, PythonCiphertext&>(
+                    &PythonContext::EvalMultInPlace),
+                    "In place multiplication of ciphertext a with ciphertext b.",
+                    py::arg("a"),
+                    py::arg("b"))
+            .def("EvalMultInPlace", py::overload_cast<PythonCiphertext&, double>(&PythonContext::EvalMultInPlace),
+                    "In place multiplication of ciphertext a with floating point number b.",
+                    py::arg("a"),
+                    py::arg("b"))
+            .def("RescaleInPlace", &PythonContext::RescaleInPlace,
+                    "Rescale a ciphertext in place.",
+                    py::arg("a"))
+            .def("EvalAddAsync",
+                    [](PythonContext self, PythonCiphertext a, PythonCiphertext b) {
+                        return AsAwaitable(SubmitPython([self, a, b]() mutable { return self.EvalAdd(a, b); }));
+                    },
+                    "Addition of two ciphertexts on the task scheduler, returns an awaitable.",
+                    py::arg("a"),
+                    py::arg("b"))
+            .def("EvalMultAsync",
+                    [](PythonContext self, PythonCiphertext a, PythonCiphertext b) {
+                        return AsAwaitable(SubmitPython([self, a, b]() mutable { return self.EvalMult(a, b); }));
+                    },
+                    "Multiplication of two ciphertexts on the task scheduler, returns an awaitable.",
+                    py::arg("a"),
+                    py::arg("b"))
+            .def("EvalMultAsync",
+                    [](PythonContext self, double a, PythonCiphertext b) {
+                        return AsAwaitable(SubmitPython([self, a, b]() mutable { return self.EvalMult(a, b); }));
+                    },
+                    "Multiplication of a floating point number a with a ciphertext b on the task scheduler, returns an "
+                    "awaitable.",
+                    py::arg("a"),
+                    py::arg("b"));
+}
+
+
+/***
+ * Defines the control of the intra op (OpenMP) and inter op (task scheduler) threads.
+ */
+void defineThreading (py::module_& m) {
+    m.def("SetThreads", &SetThreads,
+          "Set the OpenMP threads per operation and the task scheduler threads, None keeps the current value.",
+          py::call_guard<py::gil_scoped_release>(),
+          py::arg("intra_op")=py::none(),
+          py::arg("inter_op")=py::none());
+    m.def("GetThreads", &GetThreadConfiguration,
+          "Effective number of intra op and inter op threads of the calling thread.");
+
+    py::class_<ThreadBudgetScope>(m, "IntraOpThreads")
+            .def(py::init<uint32_t>(),
+                 "Context manager overriding the OpenMP threads per operation of the calling thread.",
+                 py::arg("count"))
+            .def("__enter__", [](ThreadBudgetScope& self) { self.enter(); return &self; },
+                 py::return_value_policy::reference_internal)
+            .def("__exit__", [](ThreadBudgetScope& self, py::object, py::object, py::object) { self.exit(); });
+
+    m.def("BenchmarkThreads",
+          [](std::shared_ptr<Sequential> model, PythonCiphertext x, uint32_t requests,
+             std::vector<std::pair<uint32_t, uint32_t>> configurations) {
+              std::vector<ThreadBenchmarkResult> results;
+              {
+                  py::gil_scoped_release release;
+                  results = BenchmarkThreads(model, x, requests, configurations);
+              }
+
+              py::list list;
+              for (auto& result : results) {
+                  py::dict entry;
+                  entry["intra_op"] = result.intraOp;
+                  entry["inter_op"] = result.interOp;
+                  entry["mean_latency"] = result.meanLatency;
+                  entry["median_latency"] = result.medianLatency;
+                  entry["max_latency"] = result.maxLatency;
+                  entry["throughput"] = result.throughput;
+                  list.append(entry);
+              }
+              return list;
+          },
+          "Run a pipeline under (intra_op, inter_op) thread configurations and report latency and throughput.",
+          py::arg("model"),
+          py::arg("x"),
+          py::arg("requests")=16,
+          py::arg("configurations")=std::vector<std::pair<uint32_t, uint32_t>>());
+}
+
+
+/***
+ * Defines the pipeline class chaining operators.
+ */
+void defineSequential (py::module_& m) {
+    py::class_<Sequential, std::shared_ptr<Sequential>>(m, "Sequential")
+            .def(py::init<std::vector<std::shared_ptr<Operator>>>(),
+                 "Chain operators, evaluated under the global context.",
+                 py::arg("operators"))
+            .def(py::init<std::vector<std::shared_ptr<Operator>>, PythonContext>(),
+                 "Chain operators, evaluated under the given context instead of the global one.",
+                 py::arg("operators"),
+                 py::arg("context"))
+            .def("__call__", &Sequential::forward, py::call_guard<py::gil_scoped_release>(), py::arg("x"))
+            .def("submit",
+                 [](std::shared_ptr<Sequential> self, PythonCiphertext x) {
+                     auto future = MakePythonFuture();
+                     self->submit(x, future.second);
+                     return future.first;
+                 },
+                 "Run the pipeline on the task scheduler, returns a concurrent.futures.Future.",
+                 py::arg("x"))
+            .def("ForwardAsync",
+                 [](std::shared_ptr<Sequential> self, PythonCiphertext x) {
+                     auto future = MakePythonFuture();
+                     self->submit(x, future.second);
+                     return AsAwaitable(future.first);
+                 },
+                 "Run the pipeline on the task scheduler, returns an awaitable.",
+                 py::arg("x"))
+            .def("__len__", &Sequential::size)
+            .def("GetOperators", &Sequential::GetOperators)
+            .def("IsBound", &Sequential::IsBound)
+            .def("GetContext", &Sequential::GetContext)
+            .def("Profile",
+                 [](Sequential& self, PythonCiphertext x, bool resetPeak) {
+                     std::vector<LayerMemoryUsage> usage;
+                     {
+                         py::gil_scoped_release release;
+                         usage = self.Profile(x, resetPeak);
+                     }
+
+                     py::list list;
+                     for (auto& layer : usage) {
+                         py::dict entry;
+                         entry["name"] = layer.name;
+                         entry["seconds"] = layer.seconds;
+                         entry["output_bytes"] = layer.outputBytes;
+                         entry["io_bytes"] = layer.ioBytes;
+                         entry["resident_bytes"] = layer.residentBytes;
+                         entry["peak_resident_bytes"] = layer.peakResidentBytes;
+                         entry["peak_is_per_layer"] = layer.peakIsPerLayer;
+                         entry["peak_growth_bytes"] = layer.peakGrowthBytes;
+                         list.append(entry);
+                     }
+                     return list;
+                 },
+                 "Run the pipeline and record the ciphertext and resident memory after every operator. reset_peak "
+                 "resets the process wide peak resident memory before every operator.",
+                 py::arg("x"),
+                 py::arg("reset_peak")=false)
+            .def("SetIntraOpThreads", &Sequential::SetIntraOpThreads, py::arg("count"))
+            .def("GetIntraOpThreads", &Sequential::GetIntraOpThreads);
+}
+
+
+/***
+ * Defines the container classes for storing many ciphertexts in a single file.
+ */
+void defineDatasetModules (py::module_& m) {
+    py::class_<CiphertextDatasetWriter>(m, "DatasetWriter")
+            .def(py::init<std::string, bool>(),
+                 "Open a dataset file for writing, optionally appending to an existing dataset.",
+                 py::arg("filePath"),
+                 py::arg("append")=false)
+            .def("append", &CiphertextDatasetWriter::append,
+                 "Append a ciphertext to the dataset.",
+                 py::arg("ciphertext"))
+            .def("close", &CiphertextDatasetWriter::close,
+                 "Write the index and close the file.")
+            .def("__len__", &CiphertextDatasetWriter::size)
+            .def("__enter__", [](CiphertextDatasetWriter& self) -> CiphertextDatasetWriter& { return self; },
+                 py::return_value_policy::reference)
+            .def("__exit__", [](CiphertextDatasetWriter& self, py::args) { self.close(); });
+
+    py::class_<CiphertextDatasetReader>(m, "DatasetReader")
+            .def(py::init<std::string>(),
+                 "Memory map a dataset file for random access.",
+                 py::arg("filePath"))
+            .def("getContext", &CiphertextDatasetReader::getContext,
+                 "Context of the dataset, taken from its first ciphertext.")
+            .def("getBatch", &CiphertextDatasetReader::getBatch,
+                 "Get count consecutive ciphertexts starting at start.",
+                 py::arg("start"),
+                 py::arg("count"))
+            .def("__len__", &CiphertextDatasetReader::size)
+            .def("__getitem__", &CiphertextDatasetReader::get, py::arg("index"));
 }
 
 
@@ -206,43 +501,174 @@ void defineBasicOpenFHEModules (py::module_& m) {
  * Defines wrappers around the NeuralOFHE classes
  */
 void defineNeuralOFHETypes (py::module_& m) {
-    py::class_<Operator, PythonOperator>(m, "Operator")
+    py::class_<Operator, PythonOperator, std::shared_ptr<Operator>>(m, "Operator")
             .def(py::init<uint32_t&, std::string>())
-            .def("GetName", &Operator::getName);
-
-    py::class_<nn::Conv2D, PyImpl<nn::Conv2D>, Operator>(m, "Conv2D")
+            .def("GetName", &Operator::getName)
+            .def("Bind",
+                 [](std::shared_ptr<Operator> self, PythonContext context) {
+                     return std::make_shared<BoundOperator>(self, context.getContext());
+                 },
+                 "Evaluate the operator under the given context instead of the global one.",
+                 py::arg("context"));
+
+    py::class_<BoundOperator, Operator, std::shared_ptr<BoundOperator>>(m, "BoundOperator")
+            .def("__call__", initForward<BoundOperator>(), py::call_guard<py::gil_scoped_release>())
+            .def("ForwardAsync", initForwardAsync<BoundOperator>())
+            .def("GetOperator", &BoundOperator::GetOperator)
+            .def("GetContext",
+                 [](BoundOperator& self) {
+                     PythonContext context;
+                     context.SetContext(self.GetContext());
+                     return context;
+                 });
+
+    py::class_<nn::Conv2D, PyImpl<nn::Conv2D>, Operator, std::shared_ptr<nn::Conv2D>>(m, "Conv2D")
             .def(py::init<matVec, std::vector<double>>())
-            .def("__call__", initForward<nn::Conv2D>());
+            .def("__call__", initForward<nn::Conv2D>(), py::call_guard<py::gil_scoped_release>())
+            .def("ForwardAsync", initForwardAsync<nn::Conv2D>());
 
-    py::class_<nn::Gemm, PyImpl<nn::Gemm>, Operator>(m, "Gemm")
+    py::class_<nn::Gemm, PyImpl<nn::Gemm>, Operator, std::shared_ptr<nn::Gemm>>(m, "Gemm")
             .def(py::init<matVec, std::vector<double>>())
-            .def("__call__", initForward<nn::Gemm>());
+            .def("__call__", initForward<nn::Gemm>(), py::call_guard<py::gil_scoped_release>())
+            .def("ForwardAsync", initForwardAsync<nn::Gemm>());
 
-    py::class_<nn::AveragePool, PyImpl<nn::AveragePool>, Operator>(m, "AveragePool")
+    py::class_<nn::AveragePool, PyImpl<nn::AveragePool>, Operator, std::shared_ptr<nn::AveragePool>>(m, "AveragePool")
             .def(py::init<matVec>())
-            .def("__call__", initForward<nn::AveragePool>());
+            .def("__call__", initForward<nn::AveragePool>(), py::call_guard<py::gil_scoped_release>())
+            .def("ForwardAsync", initForwardAsync<nn::AveragePool>());
 
-    py::class_<nn::BatchNorm, PyImpl<nn::BatchNorm>, Operator>(m, "BatchNorm")
+    py::class_<nn::BatchNorm, PyImpl<nn::BatchNorm>, Operator, std::shared_ptr<nn::BatchNorm>>(m, "BatchNorm")
             .def(py::init<matVec, std::vector<double>>(),
                     py::arg("weights"), py::arg("biases"))
-            .def("__call__", initForward<nn::BatchNorm>());
+            .def("__call__", initForward<nn::BatchNorm>(), py::call_guard<py::gil_scoped_release>())
+            .def("ForwardAsync", initForwardAsync<nn::BatchNorm>());
 
 
-    py::class_<ActivationFunction, PythonActivation, Operator>(m, "ActivationFunction")
+    py::class_<ActivationFunction, PythonActivation, Operator, std::shared_ptr<ActivationFunction>>(
+            m, "ActivationFunction")
             .def(py::init<double, double, uint32_t, uint32_t&, std::string>());
 
-    py::class_<nn::ReLU, ActivationFunction>(m, "ReLU")
-            .def(py::init<double, double, unsigned int>())
-            .def("__call__", initForward<nn::ReLU>());
-
-    py::class_<nn::SiLU, ActivationFunction>(m, "SiLU")
-            .def(py::init<double, double, unsigned int>())
-            .def("__call__", initForward<nn::SiLU>());
-
-    py::class_<nn::Sigmoid, ActivationFunction>(m, "Sigmoid")
-            .def(py::init<double, double, unsigned int>())
-            .def("__call__", initForward<nn::Sigmoid>());
-
+    py::class_<nn::ReLU, ActivationFunction, std::shared_ptr<nn::ReLU>>(m, "ReLU")
+            .def(py::init([](double lower, double upper, uint32_t degree) -> std::shared_ptr<nn::ReLU> {
+                     return std::make_shared<CachedActivation<nn::ReLU>>("relu", lower, upper, degree);
+                 }),
+                 "Coefficients are shared with every ReLU of the same interval and degree and fitted once.",
+                 py::arg("lower"),
+                 py::arg("upper"),
+                 py::arg("degree"))
+            .def("__call__", initForward<nn::ReLU>(), py::call_guard<py::gil_scoped_release>())
+            .def("ForwardAsync", initForwardAsync<nn::ReLU>());
+
+    py::class_<nn::SiLU, ActivationFunction, std::shared_ptr<nn::SiLU>>(m, "SiLU")
+            .def(py::init([](double lower, double upper, uint32_t degree) -> std::shared_ptr<nn::SiLU> {
+                     return std::make_shared<CachedActivation<nn::SiLU>>("silu", lower, upper, degree);
+                 }),
+                 "Coefficients are shared with every SiLU of the same interval and degree and fitted once.",
+                 py::arg("lower"),
+                 py::arg("upper"),
+                 py::arg("degree"))
+            .def("__call__", initForward<nn::SiLU>(), py::call_guard<py::gil_scoped_release>())
+            .def("ForwardAsync", initForwardAsync<nn::SiLU>());
+
+    py::class_<nn::Sigmoid, ActivationFunction, std::shared_ptr<nn::Sigmoid>>(m, "Sigmoid")
+            .def(py::init([](double lower, double upper, uint32_t degree) -> std::shared_ptr<nn::Sigmoid> {
+                     return std::make_shared<CachedActivation<nn::Sigmoid>>("sigmoid", lower, upper, degree);
+                 }),
+                 "Coefficients are shared with every Sigmoid of the same interval and degree and fitted once.",
+                 py::arg("lower"),
+                 py::arg("upper"),
+                 py::arg("degree"))
+            .def("__call__", initForward<nn::Sigmoid>(), py::call_guard<py::gil_scoped_release>())
+            .def("ForwardAsync", initForwardAsync<nn::Sigmoid>());
+
+    py::class_<PackedConv2D, PyImpl<PackedConv2D>, Operator, std::shared_ptr<PackedConv2D>>(m, "PackedConv2D")
+            .def(py::init(&MakePackedConv2D),
+                 "Convolution with a kernel of shape (out_channels, in_channels, kernel_height, kernel_width) on an "
+                 "input of shape (channels, height, width) packed channel by channel.",
+                 py::arg("kernel"),
+                 py::arg("bias"),
+                 py::arg("input_shape"),
+                 py::arg("stride")=1,
+                 py::arg("padding")=0)
+            .def("__call__", initForward<PackedConv2D>(), py::call_guard<py::gil_scoped_release>())
+            .def("ForwardAsync", initForwardAsync<PackedConv2D>())
+            .def("GetRotationIndices", &PackedConv2D::GetRotationIndices,
+                 "Rotation indices to pass to Context.GenRotateKeys.",
+                 py::arg("slots"))
+            .def("GetRotationCount", &PackedConv2D::GetRotationCount,
+                 "Number of key switching rotations of one call.",
+                 py::arg("slots"))
+            .def("GetMultiplicationCount", &PackedConv2D::GetMultiplicationCount,
+                 "Number of plaintext multiplications of one call.",
+                 py::arg("slots"))
+            .def("ClearEncodings", &PackedConv2D::ClearEncodings,
+                 "Drop the masks encoded for every context, those of destroyed contexts are dropped automatically.")
+            .def_static("FromMatrix", &PackedConv2DFromMatrix,
+                        "Convolution from the unrolled (inputs, outputs) matrix taken by Conv2D.",
+                        py::arg("weights"),
+                        py::arg("bias"),
+                        py::arg("input_shape"),
+                        py::arg("kernel_size"),
+                        py::arg("stride")=1,
+                        py::arg("padding")=0);
+
+    py::class_<PolynomialActivation, PyImpl<PolynomialActivation>, Operator, std::shared_ptr<PolynomialActivation>>(
+            m, "PolynomialActivation")
+            .def(py::init<std::string, double, double, uint32_t, ApproximationMode, uint32_t>(),
+                    "Approximate relu, sign, silu, sigmoid or tanh on [lower, upper] with the given mode.",
+                    py::arg("function"),
+                    py::arg("lower"),
+                    py::arg("upper"),
+                    py::arg("degree"),
+                    py::arg("mode")=ApproximationMode::CHEBYSHEV,
+                    py::arg("stages")=1)
+            .def("__call__", initForward<PolynomialActivation>(), py::call_guard<py::gil_scoped_release>())
+            .def("ForwardAsync", initForwardAsync<PolynomialActivation>())
+            .def("GetDepth", &PolynomialActivation::GetDepth,
+                    "Multiplicative depth consumed by the activation.")
+            .def("GetErrorBound", &PolynomialActivation::GetErrorBound,
+                    "Maximal approximation error on the interval.")
+            .def("GetCoefficients", &PolynomialActivation::GetCoefficients)
+            .def("GetMode", &PolynomialActivation::GetMode)
+            .def("EvalPlain", &PolynomialActivation::EvalPlain,
+                    "Evaluate the approximation on a plain value.",
+                    py::arg("x"))
+            .def_static("FromFunction", &FitPythonActivation,
+                    "Fit a Chebyshev approximation to a vectorized function, called once on all sample points.",
+                    py::arg("function"),
+                    py::arg("lower"),
+                    py::arg("upper"),
+                    py::arg("degree"),
+                    py::arg("mode")=ApproximationMode::CHEBYSHEV)
+            .def_static("FromCoefficients",
+                    [](std::vector<std::vector<double>> coefficients, double lower, double upper,
+                            ApproximationMode mode) {
+                        return PolynomialActivation(coefficients, lower, upper, mode);
+                    },
+                    "Create an activation from coefficients in the layout returned by GetCoefficients.",
+                    py::arg("coefficients"),
+                    py::arg("lower"),
+                    py::arg("upper"),
+                    py::arg("mode")=ApproximationMode::CHEBYSHEV)
+            .def("save", &PolynomialActivation::save,
+                    "Serialize the activation including its coefficients to a file.",
+                    py::arg("filePath"))
+            .def_static("load", &PolynomialActivation::load,
+                    "Deserialize an activation from a file.",
+                    py::arg("filePath"))
+            .def(py::pickle(
+                    [](PolynomialActivation& self) {
+                        return py::make_tuple(self.GetCoefficients(), self.GetLower(), self.GetUpper(),
+                                              self.GetMode(), self.GetFunction(), self.GetStages(),
+                                              self.GetErrorBound());
+                    },
+                    [](py::tuple state) {
+                        return PolynomialActivation(state[0].cast<std::vector<std::vector<double>>>(),
+                                                    state[1].cast<double>(), state[2].cast<double>(),
+                                                    state[3].cast<ApproximationMode>(),
+                                                    state[4].cast<std::string>(), state[5].cast<uint32_t>(),
+                                                    state[6].cast<double>());
+                    }));
 }
 
 
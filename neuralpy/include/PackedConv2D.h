@@ -0,0 +1,427 @@
+/**
+ * @file PackedConv2D.h
+ *
+ * @brief This file includes a convolution operator that, unlike the NeuralOFHE Conv2D, knows the geometry of the
+ * convolution. All input channels are packed channel by channel into one ciphertext and the output is packed the same
+ * way. Every weight moves an input slot to an output slot by a fixed rotation, which is split into a baby step applied
+ * to the input and a giant step applied after the weights have been multiplied in, so the rotated copies of the input
+ * are computed once, with a single hoisted decomposition, and shared by all filters and output positions. Strided
+ * outputs are gathered by the same plaintext multiplication that applies the weights, so they need no extra level.
+ */
+#ifndef NEURALPY_PACKEDCONV2D_H
+#define NEURALPY_PACKEDCONV2D_H
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "NeuralOFHE/NeuralOFHE.h"
+
+#include "ContextBinding.h"
+#include "OpenFHEPrerequisites.h"
+
+
+namespace convolution {
+    /***
+     * Shape of a two dimensional convolution with zero padding.
+     */
+    struct Geometry {
+        uint32_t inChannels, height, width;
+        uint32_t outChannels, kernelHeight, kernelWidth;
+        uint32_t stride = 1;
+        uint32_t padding = 0;
+
+        uint32_t outHeight() const {
+            return (height + 2 * padding - kernelHeight) / stride + 1;
+        }
+
+        uint32_t outWidth() const {
+            return (width + 2 * padding - kernelWidth) / stride + 1;
+        }
+
+        uint32_t inputs() const {
+            return inChannels * height * width;
+        }
+
+        uint32_t outputs() const {
+            return outChannels * outHeight() * outWidth();
+        }
+
+        void validate() const {
+            if (!inChannels || !height || !width || !outChannels || !kernelHeight || !kernelWidth || !stride)
+                throw std::invalid_argument("Convolution dimensions must not be zero.");
+            if (kernelHeight > height + 2 * padding || kernelWidth > width + 2 * padding)
+                throw std::invalid_argument("Kernel is larger than the padded input.");
+        }
+    };
+
+    /***
+     * A single weight of the convolution, connecting an input slot to an output slot.
+     */
+    struct Tap {
+        uint32_t output;
+        uint32_t input;
+        double weight;
+    };
+
+    /***
+     * Masks grouped by giant step and baby step. The mask of a pair holds the weights at the slots the giant step moves
+     * to their outputs.
+     */
+    struct Plan {
+        uint32_t slots = 0;
+        std::vector<int32_t> babySteps;
+        std::map<int32_t, std::map<int32_t, std::vector<double>>> masks;
+        uint32_t rotations = 0;
+        uint32_t products = 0;
+    };
+
+    int32_t Modulo(int64_t value, uint32_t slots) {
+        int64_t result = value % slots;
+        return static_cast<int32_t>(result < 0 ? result + slots : result);
+    }
+
+    /***
+     * Taps of a kernel of shape (out channels, in channels, kernel height, kernel width).
+     */
+    std::vector<Tap> TapsFromKernel(const Geometry& g, const std::vector<double>& kernel) {
+        if (kernel.size() != (size_t) g.outChannels * g.inChannels * g.kernelHeight * g.kernelWidth)
+            throw std::invalid_argument("Kernel size does not match the convolution dimensions.");
+
+        std::vector<Tap> taps;
+        uint32_t oh = g.outHeight(), ow = g.outWidth();
+        for (uint32_t o = 0; o < g.outChannels; o++)
+        for (uint32_t oy = 0; oy < oh; oy++)
+        for (uint32_t ox = 0; ox < ow; ox++)
+        for (uint32_t c = 0; c < g.inChannels; c++)
+        for (uint32_t dy = 0; dy < g.kernelHeight; dy++)
+        for (uint32_t dx = 0; dx < g.kernelWidth; dx++) {
+            int64_t iy = (int64_t) oy * g.stride + dy - g.padding;
+            int64_t ix = (int64_t) ox * g.stride + dx - g.padding;
+            double weight = kernel[((o * g.inChannels + c) * g.kernelHeight + dy) * g.kernelWidth + dx];
+            if (iy < 0 || ix < 0 || iy >= g.height || ix >= g.width || weight == 0)
+                continue;
+
+            taps.push_back({(o * oh + oy) * ow + ox, (uint32_t) ((c * g.height + iy) * g.width + ix), weight});
+        }
+
+        return taps;
+    }
+
+    /***
+     * Taps of a convolution unrolled into a dense matrix with one row per input and one column per output.
+     */
+    std::vector<Tap> TapsFromMatrix(const Geometry& g, const matVec& matrix) {
+        if (matrix.size() != g.inputs() || (!matrix.empty() && matrix[0].size() != g.outputs()))
+            throw std::invalid_argument("Expected a matrix of shape (" + std::to_string(g.inputs()) + ", " +
+                                        std::to_string(g.outputs()) + ").");
+
+        std::vector<Tap> taps;
+        for (uint32_t i = 0; i < matrix.size(); i++)
+            for (uint32_t j = 0; j < matrix[i].size(); j++)
+                if (matrix[i][j] != 0)
+                    taps.push_back({j, i, matrix[i][j]});
+
+        return taps;
+    }
+
+    /***
+     * Giant step moving the gathered products of an output row to it. Every output of a row of an output channel uses
+     * the same giant step, so the baby step only depends on the input channel, the kernel offset and the output column.
+     */
+    int32_t RowGiantStep(const Geometry& g, const Tap& tap, uint32_t slots) {
+        uint32_t oh = g.outHeight(), ow = g.outWidth();
+        int64_t o = tap.output / (oh * ow);
+        int64_t oy = tap.output % (oh * ow) / ow;
+
+        return Modulo(((int64_t) g.stride * oy - g.padding) * g.width - g.padding - o * oh * ow - oy * ow, slots);
+    }
+
+    /***
+     * Splits the rotation of every tap into a baby and a giant step, either by output rows or by a fixed baby step
+     * range, whichever needs fewer rotations.
+     *
+     * @param g Geometry of the convolution
+     * @param taps Weights of the convolution
+     * @param slots Number of slots the rotations are cyclic in
+     * @return Plan with the masks
+     */
+    Plan MakePlan(const Geometry& g, const std::vector<Tap>& taps, uint32_t slots) {
+        if (g.inputs() > slots || g.outputs() > slots)
+            throw std::invalid_argument("Input and output of the convolution have to fit into " +
+                                        std::to_string(slots) + " slots.");
+
+        std::vector<int32_t> shifts(taps.size());
+        for (size_t i = 0; i < taps.size(); i++)
+            shifts[i] = Modulo((int64_t) taps[i].input - taps[i].output, slots);
+
+        //  Rotations and products of splitting every rotation into shift - giant(tap) and giant(tap)
+        auto cost = [&](auto giantOf) {
+            std::set<int32_t> babies, giants;
+            std::set<std::pair<int32_t, int32_t>> pairs;
+            for (size_t i = 0; i < taps.size(); i++) {
+                int32_t giant = giantOf(i);
+                int32_t baby = Modulo((int64_t) shifts[i] - giant, slots);
+                babies.insert(baby);
+                giants.insert(giant);
+                pairs.emplace(giant, baby);
+            }
+
+            return std::make_pair(babies.size() - babies.count(0) + giants.size() - giants.count(0), pairs.size());
+        };
+
+        auto byRows = [&](size_t i) { return RowGiantStep(g, taps[i], slots); };
+        auto best = cost(byRows);
+        uint32_t bestRange = 0;
+
+        std::set<int32_t> distinct(shifts.begin(), shifts.end());
+        uint32_t limit = std::min<uint32_t>(slots, 4 * std::ceil(std::sqrt(slots)));
+        for (uint32_t range = 1; range <= limit; range++) {
+            std::set<int32_t> babies, giants;
+            for (int32_t shift : distinct) {
+                babies.insert(shift % range);
+                giants.insert(shift - shift % range);
+            }
+
+            size_t rotations = babies.size() - babies.count(0) + giants.size() - giants.count(0);
+            if (rotations < best.first || (rotations == best.first && distinct.size() < best.second)) {
+                best = {rotations, distinct.size()};
+                bestRange = range;
+            }
+        }
+
+        Plan plan;
+        plan.slots = slots;
+        std::set<int32_t> babies;
+        for (size_t i = 0; i < taps.size(); i++) {
+            int32_t giant = bestRange ? shifts[i] - shifts[i] % bestRange : byRows(i);
+            int32_t baby = Modulo((int64_t) shifts[i] - giant, slots);
+
+            auto& mask = plan.masks[giant][baby];
+            if (mask.empty())
+                mask.resize(slots);
+            mask[Modulo((int64_t) taps[i].output + giant, slots)] += taps[i].weight;
+            babies.insert(baby);
+        }
+
+        plan.babySteps.assign(babies.begin(), babies.end());
+        plan.rotations = best.first;
+        plan.products = best.second;
+        return plan;
+    }
+}
+
+
+class PackedConv2D : public Operator, public ContextFree {
+public:
+    /***
+     * Creates a convolution from its kernel.
+     *
+     * @param kernel Weights of shape (out channels, in channels, kernel height, kernel width), flattened
+     * @param bias One value per output channel
+     * @param geometry Shape of the convolution
+     */
+    PackedConv2D(std::vector<double> kernel, std::vector<double> bias, convolution::Geometry geometry)
+            : Operator(instances, "PackedConv2D"), geometry(validated(geometry)), bias(bias) {
+        taps = convolution::TapsFromKernel(geometry, kernel);
+        checkBias();
+    }
+
+    /***
+     * Creates a convolution from the dense matrix the NeuralOFHE Conv2D takes, with one row per input and one column
+     * per output, both packed channel by channel.
+     *
+     * @param weights Unrolled convolution
+     * @param bias One value per output or per output channel
+     * @param geometry Shape of the convolution
+     */
+    PackedConv2D(matVec weights, std::vector<double> bias, convolution::Geometry geometry)
+            : Operator(instances, "PackedConv2D"), geometry(validated(geometry)), bias(bias) {
+        taps = convolution::TapsFromMatrix(geometry, weights);
+        checkBias();
+    }
+
+    Cipher forward(Cipher x) override {
+        auto cc = x->GetCryptoContext();
+        uint32_t slots = cc->GetEncodingParams()->GetBatchSize();
+        const convolution::Plan& plan = GetPlan(slots);
+        const Encoding& encoding = getEncoding(cc, slots, x->GetLevel());
+
+        auto digits = cc->EvalFastRotationPrecompute(x);
+        std::map<int32_t, Cipher> rotated;
+        for (int32_t baby : plan.babySteps)
+            rotated[baby] = baby == 0 ? x : cc->EvalFastRotation(x, baby, cc->GetCyclotomicOrder(), digits);
+
+        Cipher result;
+        for (auto& giant : plan.masks) {
+            Cipher gathered;
+            for (auto& term : giant.second) {
+                Cipher product = cc->EvalMult(rotated[term.first], encoding.masks.at(giant.first).at(term.first));
+                if (gathered)
+                    cc->EvalAddInPlace(gathered, product);
+                else
+                    gathered = product;
+            }
+
+            if (giant.first != 0)
+                gathered = cc->EvalRotate(gathered, giant.first);
+            if (result)
+                cc->EvalAddInPlace(result, gathered);
+            else
+                result = gathered;
+        }
+
+        cc->EvalAddInPlace(result, encoding.bias);
+        result->SetSlots(geometry.outputs());
+
+        return result;
+    }
+
+    /***
+     * Plan of the rotations for the given number of slots, computed on first use.
+     *
+     * @param slots Batch size of the context
+     * @return Plan
+     */
+    const convolution::Plan& GetPlan(uint32_t slots) {
+        std::lock_guard<std::mutex> lock(planMutex);
+        auto it = plans.find(slots);
+        if (it == plans.end())
+            it = plans.emplace(slots, convolution::MakePlan(geometry, taps, slots)).first;
+
+        return it->second;
+    }
+
+    /***
+     * Rotation indices the convolution needs keys for.
+     *
+     * @param slots Batch size of the context
+     * @return Rotation indices
+     */
+    std::vector<int32_t> GetRotationIndices(uint32_t slots) {
+        const convolution::Plan& plan = GetPlan(slots);
+
+        std::set<int32_t> indices;
+        for (int32_t baby : plan.babySteps)
+            if (baby != 0)
+                indices.insert(baby);
+        for (auto& giant : plan.masks)
+            if (giant.first != 0)
+                indices.insert(giant.first);
+
+        return std::vector<int32_t>(indices.begin(), indices.end());
+    }
+
+    /***
+     * Number of key switching rotations of one call of forward.
+     *
+     * @param slots Batch size of the context
+     * @return Number of rotations
+     */
+    uint32_t GetRotationCount(uint32_t slots) {
+        return GetPlan(slots).rotations;
+    }
+
+    /***
+     * Number of plaintext multiplications of one call of forward.
+     *
+     * @param slots Batch size of the context
+     * @return Number of multiplications
+     */
+    uint32_t GetMultiplicationCount(uint32_t slots) {
+        return GetPlan(slots).products;
+    }
+
+    const convolution::Geometry& GetGeometry() {
+        return geometry;
+    }
+
+    /***
+     * Drops the masks and the bias encoded for all contexts to free their memory. Encodings of destroyed contexts are
+     * dropped on the next call of forward anyway.
+     */
+    void ClearEncodings() {
+        std::lock_guard<std::mutex> lock(planMutex);
+        encodings.clear();
+    }
+
+private:
+    /***
+     * Masks and bias encoded for one context and input level.
+     */
+    struct Encoding {
+        //  The encodings do not keep the context alive, they are dropped once it is destroyed
+        std::weak_ptr<CryptoContextImpl<DCRTPoly>> context;
+        std::map<int32_t, std::map<int32_t, Plaintext>> masks;
+        Plaintext bias;
+    };
+
+    /***
+     * Masks and bias encoded at the level of the input, computed on first use. They take one plaintext per product of
+     * the plan, each with the RNS limbs left at that level.
+     *
+     * @param cc Context of the input
+     * @param slots Batch size of the context
+     * @param level Level of the input
+     * @return Encoded masks and bias
+     */
+    const Encoding& getEncoding(const Context& cc, uint32_t slots, uint32_t level) {
+        const convolution::Plan& plan = GetPlan(slots);
+
+        std::lock_guard<std::mutex> lock(planMutex);
+        //  A new context may reuse the address of a destroyed one, so its encodings are dropped first
+        std::erase_if(encodings, [](const auto& entry) { return entry.second.context.expired(); });
+
+        auto key = std::make_tuple(cc.get(), slots, level);
+        auto it = encodings.find(key);
+        if (it != encodings.end())
+            return it->second;
+
+        Encoding encoding;
+        encoding.context = cc;
+        for (auto& giant : plan.masks)
+            for (auto& term : giant.second)
+                encoding.masks[giant.first][term.first] = cc->MakeCKKSPackedPlaintext(term.second, 1, level, nullptr,
+                                                                                      slots);
+        encoding.bias = cc->MakeCKKSPackedPlaintext(getBiasVector(slots), 1, level, nullptr, slots);
+
+        return encodings.emplace(key, std::move(encoding)).first->second;
+    }
+
+    static convolution::Geometry validated(convolution::Geometry geometry) {
+        geometry.validate();
+        return geometry;
+    }
+
+    void checkBias() {
+        if (!bias.empty() && bias.size() != geometry.outChannels && bias.size() != geometry.outputs())
+            throw std::invalid_argument("Expected one bias per output channel or per output.");
+    }
+
+    std::vector<double> getBiasVector(uint32_t slots) {
+        std::vector<double> values(slots, 0.0);
+        uint32_t perChannel = geometry.outHeight() * geometry.outWidth();
+        for (uint32_t i = 0; i < geometry.outputs() && !bias.empty(); i++)
+            values[i] = bias.size() == geometry.outputs() ? bias[i] : bias[i / perChannel];
+
+        return values;
+    }
+
+    static inline uint32_t instances = 0;
+
+    convolution::Geometry geometry;
+    std::vector<double> bias;
+    std::vector<convolution::Tap> taps;
+
+    std::mutex planMutex;
+    std::map<uint32_t, convolution::Plan> plans;
+    std::map<std::tuple<const CryptoContextImpl<DCRTPoly>*, uint32_t, uint32_t>, Encoding> encodings;
+};
+
+#endif //NEURALPY_PACKEDCONV2D_H
@@ -0,0 +1,314 @@
+/**
+ * @file PolynomialActivation.h
+ *
+ * @brief This file includes an activation function operator that, unlike the NeuralOFHE activation functions, lets the
+ * user choose how the function is approximated and evaluated. Every instance reports the multiplicative depth it
+ * consumes and the maximal approximation error on its interval. Coefficients are shared through the CoefficientCache,
+ * or given explicitly for custom functions, and are serialized together with the operator, so that evaluating it never
+ * calls back into Python.
+ */
+#ifndef NEURALPY_POLYNOMIALACTIVATION_H
+#define NEURALPY_POLYNOMIALACTIVATION_H
+
+#include "NeuralOFHE/NeuralOFHE.h"
+
+#include "cereal/archives/binary.hpp"
+#include "cereal/types/string.hpp"
+#include "cereal/types/vector.hpp"
+
+#include "ContextBinding.h"
+#include "OpenFHEPrerequisites.h"
+#include "PolynomialApproximation.h"
+
+
+class PolynomialActivation : public Operator, public ContextFree {
+public:
+    /***
+     * Creates an approximation of a named activation function.
+     *
+     * @param function Name of the function, see GetActivationFunction
+     * @param lower Lower bound of the interval the inputs are expected in
+     * @param upper Upper bound of the interval the inputs are expected in
+     * @param degree Degree of the polynomial, for COMPOSITE the degree of every stage, ignored for SQUARE
+     * @param mode How the function is approximated and evaluated
+     * @param stages Number of composed polynomials, only used for COMPOSITE
+     */
+    PolynomialActivation(std::string function, double lower, double upper, uint32_t degree,
+                         ApproximationMode mode=ApproximationMode::CHEBYSHEV, uint32_t stages=1)
+            : Operator(instances, "PolynomialActivation"), function(function), lower(lower), upper(upper),
+              degree(degree), mode(mode), stages(stages) {
+        if (lower >= upper)
+            throw std::invalid_argument("Lower bound of the interval must be smaller than the upper bound.");
+
+        if (mode == ApproximationMode::SQUARE) {
+            this->degree = 2;
+            this->stages = 1;
+        } else if (mode == ApproximationMode::COMPOSITE) {
+            if (function != "relu" && function != "sign")
+                throw std::invalid_argument("Composite approximation is only available for relu and sign.");
+            if (degree < 3 || degree % 2 == 0)
+                throw std::invalid_argument("Composite stages must have an odd degree of at least 3.");
+            if (stages == 0)
+                throw std::invalid_argument("Composite approximation needs at least one stage.");
+        } else {
+            this->stages = 1;
+        }
+
+        CoefficientCache::Key key = {function, static_cast<int>(mode), lower, upper, this->degree, this->stages};
+        Approximation approximation = CoefficientCache::instance().get(key, [this]() {
+            coefficients = computeCoefficients();
+            return Approximation{coefficients, computeErrorBound()};
+        });
+
+        coefficients = approximation.coefficients;
+        errorBound = approximation.errorBound;
+    }
+
+    /***
+     * Creates an activation from already computed coefficients, e.g. fitted to a custom function or deserialized.
+     *
+     * @param coefficients Coefficients in the layout returned by GetCoefficients
+     * @param lower Lower bound of the interval the inputs are expected in
+     * @param upper Upper bound of the interval the inputs are expected in
+     * @param mode How the coefficients are evaluated
+     * @param function Name of the approximated function, must be relu or sign for COMPOSITE
+     * @param stages Number of composed polynomials, only used for COMPOSITE
+     * @param errorBound Known approximation error, NaN if unknown
+     */
+    PolynomialActivation(std::vector<std::vector<double>> coefficients, double lower, double upper,
+                         ApproximationMode mode=ApproximationMode::CHEBYSHEV, std::string function="custom",
+                         uint32_t stages=1, double errorBound=NAN)
+            : Operator(instances, "PolynomialActivation"), function(function), lower(lower), upper(upper),
+              mode(mode), stages(stages), coefficients(coefficients), errorBound(errorBound) {
+        if (lower >= upper)
+            throw std::invalid_argument("Lower bound of the interval must be smaller than the upper bound.");
+        if (coefficients.empty() || coefficients[0].size() < 2)
+            throw std::invalid_argument("At least two coefficients are required.");
+
+        if (mode == ApproximationMode::COMPOSITE) {
+            if (function != "relu" && function != "sign")
+                throw std::invalid_argument("Composite approximation is only available for relu and sign.");
+            if (stages == 0 || (stages > 1 && coefficients.size() < 2))
+                throw std::invalid_argument("Composite approximation needs coefficients for every stage.");
+        } else {
+            this->stages = 1;
+        }
+        if (mode == ApproximationMode::SQUARE && coefficients[0].size() != 3)
+            throw std::invalid_argument("Square approximation requires exactly three coefficients.");
+
+        degree = coefficients[0].size() - 1;
+    }
+
+    Cipher forward(Cipher x) override {
+        auto cc = x->GetCryptoContext();
+
+        switch (mode) {
+            case ApproximationMode::CHEBYSHEV:
+                return cc->EvalChebyshevSeries(x, coefficients[0], lower, upper);
+            case ApproximationMode::PATERSON_STOCKMEYER:
+                return cc->EvalChebyshevSeriesPS(x, coefficients[0], lower, upper);
+            case ApproximationMode::CHEBYSHEV_LINEAR:
+                return cc->EvalChebyshevSeriesLinear(x, coefficients[0], lower, upper);
+            case ApproximationMode::SQUARE: {
+                //  x (c2 x + c1) + c0 has the same depth as c2 x^2 + c1 x + c0 with one constant multiplication less
+                const auto& c = coefficients[0];
+                Cipher inner = cc->EvalMult(x, c[2]);
+                cc->EvalAddInPlace(inner, c[1]);
+
+                Cipher result = cc->EvalMult(x, inner);
+                cc->EvalAddInPlace(result, c[0]);
+                return result;
+            }
+            case ApproximationMode::COMPOSITE: {
+                double bound = std::max(std::abs(lower), std::abs(upper));
+                Cipher sign = cc->EvalChebyshevSeries(x, coefficients[0], -bound, bound);
+                for (uint32_t i = 1; i < stages; i++)
+                    sign = cc->EvalChebyshevSeries(sign, coefficients[1], -1, 1);
+
+                if (function == "sign")
+                    return sign;
+
+                //  relu(x) = x (1 + sign(x)) / 2
+                cc->EvalAddInPlace(sign, 1.0);
+                return cc->EvalMult(cc->EvalMult(x, 0.5), sign);
+            }
+        }
+
+        return x;
+    }
+
+    /***
+     * Multiplicative depth consumed by one call of forward.
+     *
+     * @return Number of levels
+     */
+    uint32_t GetDepth() {
+        switch (mode) {
+            case ApproximationMode::CHEBYSHEV:
+            case ApproximationMode::PATERSON_STOCKMEYER:
+                return ChebyshevDepth(degree);
+            case ApproximationMode::CHEBYSHEV_LINEAR:
+                return ChebyshevDepth(degree, true);
+            case ApproximationMode::SQUARE:
+                return 2;
+            case ApproximationMode::COMPOSITE:
+                return stages * ChebyshevDepth(degree) + (function == "relu" ? 1 : 0);
+        }
+
+        return 0;
+    }
+
+    /***
+     * Maximal absolute difference between the function and its approximation, sampled on the interval.
+     *
+     * @return Error bound
+     */
+    double GetErrorBound() {
+        return errorBound;
+    }
+
+    /***
+     * Coefficients of the approximation. For COMPOSITE the first entry holds the first stage and the second entry the
+     * following stages, for SQUARE the coefficients are given in the power basis, otherwise in the Chebyshev basis.
+     *
+     * @return Coefficients of every polynomial
+     */
+    std::vector<std::vector<double>> GetCoefficients() {
+        return coefficients;
+    }
+
+    ApproximationMode GetMode() {
+        return mode;
+    }
+
+    /***
+     * Evaluates the approximation on a plain value.
+     *
+     * @param x Input
+     * @return Approximated function value
+     */
+    double EvalPlain(double x) {
+        switch (mode) {
+            case ApproximationMode::SQUARE: {
+                const auto& c = coefficients[0];
+                return c[0] + x * (c[1] + x * c[2]);
+            }
+            case ApproximationMode::COMPOSITE: {
+                double bound = std::max(std::abs(lower), std::abs(upper));
+                double sign = EvalChebyshevPlain(coefficients[0], -bound, bound, x);
+                for (uint32_t i = 1; i < stages; i++)
+                    sign = EvalChebyshevPlain(coefficients[1], -1, 1, sign);
+
+                return function == "sign" ? sign : 0.5 * x * (1 + sign);
+            }
+            default:
+                return EvalChebyshevPlain(coefficients[0], lower, upper, x);
+        }
+    }
+
+    std::string GetFunction() {
+        return function;
+    }
+
+    double GetLower() {
+        return lower;
+    }
+
+    double GetUpper() {
+        return upper;
+    }
+
+    uint32_t GetStages() {
+        return stages;
+    }
+
+    /***
+     * Serialize the activation, including its coefficients, to a file.
+     *
+     * @param filePath
+     */
+    void save(std::string filePath) {
+        std::ofstream file(filePath, std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error opening activation file " << filePath << "." << std::endl;
+            std::exit(1);
+        }
+
+        cereal::BinaryOutputArchive archive(file);
+        archive(function, lower, upper, static_cast<int>(mode), stages, errorBound, coefficients);
+        std::cout << "Activation serialized to " << filePath << "." << std::endl;
+    }
+
+    /***
+     * Deserialize an activation from a file written by save.
+     *
+     * @param filePath
+     * @return The deserialized activation
+     */
+    static PolynomialActivation load(std::string filePath) {
+        std::ifstream file(filePath, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error opening activation file " << filePath << "." << std::endl;
+            std::exit(1);
+        }
+
+        std::string function;
+        double lower, upper, errorBound;
+        int mode;
+        uint32_t stages;
+        std::vector<std::vector<double>> coefficients;
+
+        cereal::BinaryInputArchive archive(file);
+        archive(function, lower, upper, mode, stages, errorBound, coefficients);
+
+        if (mode < static_cast<int>(ApproximationMode::CHEBYSHEV) || mode > static_cast<int>(ApproximationMode::SQUARE))
+            throw std::invalid_argument("Activation file " + filePath + " has an unknown approximation mode.");
+        std::cout << "Activation deserialized from " << filePath << "." << std::endl;
+
+        return {coefficients, lower, upper, static_cast<ApproximationMode>(mode), function, stages, errorBound};
+    }
+
+private:
+    std::vector<std::vector<double>> computeCoefficients() {
+        auto func = GetActivationFunction(function);
+
+        switch (mode) {
+            case ApproximationMode::SQUARE:
+                return {LeastSquaresQuadratic(func, lower, upper)};
+            case ApproximationMode::COMPOSITE: {
+                double bound = std::max(std::abs(lower), std::abs(upper));
+                auto stage = CompositeSignStage((degree - 1) / 2);
+                auto first = ChebyshevCoefficients([&](double x) { return stage(x / bound); }, -bound, bound, degree);
+                return {first, ChebyshevCoefficients(stage, -1, 1, degree)};
+            }
+            default:
+                return {ChebyshevCoefficients(func, lower, upper, degree)};
+        }
+    }
+
+    double computeErrorBound() {
+        const uint32_t samples = 4096;
+        auto func = GetActivationFunction(function);
+
+        double maxError = 0;
+        for (uint32_t i = 0; i < samples; i++) {
+            double x = lower + (upper - lower) * i / (samples - 1);
+            maxError = std::max(maxError, std::abs(func(x) - EvalPlain(x)));
+        }
+
+        return maxError;
+    }
+
+    static inline uint32_t instances = 0;
+
+    std::string function;
+    double lower, upper;
+    uint32_t degree;
+    ApproximationMode mode;
+    uint32_t stages;
+
+    std::vector<std::vector<double>> coefficients;
+    double errorBound;
+};
+
+#endif //NEURALPY_POLYNOMIALACTIVATION_H
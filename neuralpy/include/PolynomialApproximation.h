@@ -0,0 +1,303 @@
+/**
+ * @file PolynomialApproximation.h
+ *
+ * @brief This file includes the plaintext side of approximating activation functions by polynomials. It computes
+ * Chebyshev and least squares coefficients, estimates the multiplicative depth and the approximation error, and holds
+ * a process wide cache of coefficients so that identical activation functions are only ever fitted once.
+ */
+#ifndef NEURALPY_POLYNOMIALAPPROXIMATION_H
+#define NEURALPY_POLYNOMIALAPPROXIMATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+
+/***
+ * Ways in which an activation function can be turned into a polynomial that is evaluated on a ciphertext.
+ */
+enum class ApproximationMode {
+    //  Chebyshev series, OpenFHE decides between linear and Paterson-Stockmeyer evaluation
+    CHEBYSHEV,
+    //  Chebyshev series, always evaluated with the Paterson-Stockmeyer algorithm
+    PATERSON_STOCKMEYER,
+    //  Chebyshev series, always evaluated term by term
+    CHEBYSHEV_LINEAR,
+    //  Composition of low degree odd polynomials approximating the sign function, only for sign and ReLU
+    COMPOSITE,
+    //  Least squares fit of a quadratic polynomial
+    SQUARE
+};
+
+
+/***
+ * Returns the activation function registered under the given name.
+ *
+ * @param name One of relu, sign, silu, sigmoid or tanh
+ * @return The function as a C++ lambda.
+ */
+std::function<double (double)> GetActivationFunction(const std::string& name) {
+    if (name == "relu")
+        return [](double x) -> double { return x > 0 ? x : 0; };
+    if (name == "sign")
+        return [](double x) -> double { return x > 0 ? 1 : (x < 0 ? -1 : 0); };
+    if (name == "silu")
+        return [](double x) -> double { return x / (1 + std::exp(-x)); };
+    if (name == "sigmoid")
+        return [](double x) -> double { return 1 / (1 + std::exp(-x)); };
+    if (name == "tanh")
+        return [](double x) -> double { return std::tanh(x); };
+
+    throw std::invalid_argument("Unknown activation function " + name + ".");
+}
+
+
+/***
+ * Chebyshev nodes on the interval [a, b] at which a function has to be sampled for a Chebyshev approximation of the
+ * given degree.
+ *
+ * @param a Lower bound of the interval
+ * @param b Upper bound of the interval
+ * @param degree Degree of the approximating polynomial
+ * @return degree + 1 sample points
+ */
+std::vector<double> ChebyshevNodes(double a, double b, uint32_t degree) {
+    if (degree == 0)
+        throw std::invalid_argument("The degree of the approximation can not be zero.");
+
+    uint32_t total = degree + 1;
+    double bMinusA = 0.5 * (b - a);
+    double bPlusA = 0.5 * (b + a);
+    double piByTotal = M_PI / static_cast<double>(total);
+
+    std::vector<double> nodes(total);
+    for (uint32_t i = 0; i < total; i++)
+        nodes[i] = std::cos(piByTotal * (i + 0.5)) * bMinusA + bPlusA;
+
+    return nodes;
+}
+
+
+/***
+ * Computes Chebyshev coefficients from function values sampled at the ChebyshevNodes, using the same normalization as
+ * OpenFHE's EvalChebyshevCoefficients, so the result can directly be passed to EvalChebyshevSeries.
+ *
+ * @param samples Function values at the Chebyshev nodes
+ * @return Chebyshev coefficients, one per sample
+ */
+std::vector<double> ChebyshevCoefficientsFromSamples(const std::vector<double>& samples) {
+    size_t total = samples.size();
+    double piByTotal = M_PI / static_cast<double>(total);
+
+    std::vector<double> coefficients(total, 0);
+    for (size_t i = 0; i < total; i++) {
+        for (size_t j = 0; j < total; j++)
+            coefficients[i] += samples[j] * std::cos(piByTotal * i * (j + 0.5));
+        coefficients[i] *= 2.0 / static_cast<double>(total);
+    }
+
+    return coefficients;
+}
+
+
+/***
+ * Computes the Chebyshev coefficients of a function on the interval [a, b].
+ *
+ * @param func Function to approximate
+ * @param a Lower bound of the interval
+ * @param b Upper bound of the interval
+ * @param degree Degree of the approximating polynomial
+ * @return degree + 1 Chebyshev coefficients
+ */
+std::vector<double> ChebyshevCoefficients(const std::function<double (double)>& func, double a, double b,
+                                          uint32_t degree) {
+    std::vector<double> samples = ChebyshevNodes(a, b, degree);
+    for (auto& x : samples)
+        x = func(x);
+
+    return ChebyshevCoefficientsFromSamples(samples);
+}
+
+
+/***
+ * Evaluates a Chebyshev series in the convention of OpenFHE (the first coefficient is halved) on a plain value using
+ * the Clenshaw recurrence.
+ *
+ * @param coefficients Chebyshev coefficients
+ * @param a Lower bound of the interval
+ * @param b Upper bound of the interval
+ * @param x Point at which the series is evaluated
+ * @return Value of the series
+ */
+double EvalChebyshevPlain(const std::vector<double>& coefficients, double a, double b, double x) {
+    double t = (2 * x - a - b) / (b - a);
+    double b1 = 0, b2 = 0;
+
+    for (size_t k = coefficients.size(); k-- > 1;) {
+        double tmp = 2 * t * b1 - b2 + coefficients[k];
+        b2 = b1;
+        b1 = tmp;
+    }
+
+    return t * b1 - b2 + 0.5 * coefficients[0];
+}
+
+
+/***
+ * Multiplicative depth OpenFHE needs to evaluate a Chebyshev series of a given degree, taken from the table in the
+ * OpenFHE function evaluation documentation. The depth includes the level consumed by mapping the interval to [-1, 1].
+ *
+ * @param degree Degree of the series
+ * @param linear Whether the series is evaluated term by term instead of with Paterson-Stockmeyer
+ * @return Multiplicative depth
+ */
+uint32_t ChebyshevDepth(uint32_t degree, bool linear=false) {
+    //  Interval mapping, the Chebyshev polynomials up to the degree and the multiplication with the coefficients
+    if (linear || degree < 3)
+        return static_cast<uint32_t>(std::ceil(std::log2(std::max<uint32_t>(degree, 1)))) + 2;
+
+    const std::vector<std::pair<uint32_t, uint32_t>> table = {
+            {5, 4}, {13, 5}, {27, 6}, {59, 7}, {119, 8}, {247, 9}, {495, 10}, {1007, 11}, {2031, 12}
+    };
+    for (auto& [maxDegree, depth] : table) {
+        if (degree <= maxDegree)
+            return depth;
+    }
+
+    return static_cast<uint32_t>(std::ceil(std::log2(degree))) + 2;
+}
+
+
+/***
+ * Odd polynomial f_n from Cheon et al., "Efficient Homomorphic Comparison Methods with Optimal Complexity". Composing
+ * it with itself converges to the sign function on [-1, 1].
+ *
+ * @param n The polynomial has degree 2n + 1
+ * @return The polynomial as a C++ lambda.
+ */
+std::function<double (double)> CompositeSignStage(uint32_t n) {
+    return [n](double x) -> double {
+        double result = 0, binomial = 1, power = 1;
+        for (uint32_t i = 0; i <= n; i++) {
+            result += binomial / std::pow(4., i) * x * power;
+            binomial = binomial * (2 * i + 1) * (2 * i + 2) / ((i + 1) * (i + 1));
+            power *= 1 - x * x;
+        }
+        return result;
+    };
+}
+
+
+/***
+ * Least squares fit of a quadratic polynomial c0 + c1 x + c2 x^2 to a function on [a, b].
+ *
+ * @param func Function to approximate
+ * @param a Lower bound of the interval
+ * @param b Upper bound of the interval
+ * @return Coefficients c0, c1, c2 in the power basis
+ */
+std::vector<double> LeastSquaresQuadratic(const std::function<double (double)>& func, double a, double b) {
+    const uint32_t samples = 1024;
+
+    //  Normal equations, fitted in the variable t in [-1, 1] for a well conditioned system
+    double m[3][4] = {};
+    for (uint32_t i = 0; i < samples; i++) {
+        double t = -1 + 2. * i / (samples - 1);
+        double y = func(0.5 * (b - a) * t + 0.5 * (a + b));
+        double powers[3] = {1, t, t * t};
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++)
+                m[r][c] += powers[r] * powers[c];
+            m[r][3] += powers[r] * y;
+        }
+    }
+
+    for (int col = 0; col < 3; col++) {
+        for (int row = col + 1; row < 3; row++) {
+            double factor = m[row][col] / m[col][col];
+            for (int c = col; c < 4; c++)
+                m[row][c] -= factor * m[col][c];
+        }
+    }
+    double d[3];
+    for (int row = 2; row >= 0; row--) {
+        d[row] = m[row][3];
+        for (int c = row + 1; c < 3; c++)
+            d[row] -= m[row][c] * d[c];
+        d[row] /= m[row][row];
+    }
+
+    //  Substitute t = s x + o back to obtain the coefficients in x
+    double s = 2 / (b - a), o = -(a + b) / (b - a);
+    return {d[0] + d[1] * o + d[2] * o * o, d[1] * s + 2 * d[2] * s * o, d[2] * s * s};
+}
+
+
+/***
+ * Coefficients of an approximation together with its maximal error on the interval.
+ */
+struct Approximation {
+    std::vector<std::vector<double>> coefficients;
+    //  NaN if not computed
+    double errorBound = NAN;
+};
+
+
+/***
+ * Process wide cache of approximation coefficients keyed by function, mode, interval, degree and number of stages.
+ * Fitting is done outside of the lock, so threads constructing different activations do not serialize on each other.
+ */
+class CoefficientCache {
+public:
+    typedef std::tuple<std::string, int, double, double, uint32_t, uint32_t> Key;
+
+    static CoefficientCache& instance() {
+        static CoefficientCache cache;
+        return cache;
+    }
+
+    /***
+     * Returns the cached approximation for the key, or computes and stores it if it is not cached yet.
+     *
+     * @param key Identifier of the approximation
+     * @param compute Function computing the coefficients and the error bound on a cache miss
+     * @return Coefficients of every polynomial of the approximation and its error bound
+     */
+    Approximation get(const Key& key, const std::function<Approximation ()>& compute) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(key);
+            if (it != entries.end())
+                return it->second;
+        }
+
+        Approximation approximation = compute();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.emplace(key, std::move(approximation)).first->second;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+private:
+    CoefficientCache () {}
+
+    std::mutex mutex;
+    std::map<Key, Approximation> entries;
+};
+
+#endif //NEURALPY_POLYNOMIALAPPROXIMATION_H
@@ -2,6 +2,7 @@
 #define NEURALPY_PYTHONCIPHERTEXT_H
 
 #include "OpenFHEPrerequisites.h"
+#include "MemoryAccounting.h"
 
 class PythonCiphertext {
 public:
@@ -11,10 +12,32 @@ public:
         ciphertext = cipher;
     }
 
-    Cipher getCiphertext () {
+    Cipher getCiphertext () const {
         return ciphertext;
     }
 
+    /***
+     * Returns the ciphertext for modification in place. If the underlying OpenFHE ciphertext is shared with another
+     * object it is cloned first, so in place operations never change other ciphertexts.
+     *
+     * @return Reference to the ciphertext
+     */
+    Cipher& getMutableCiphertext () {
+        if (ciphertext.use_count() > 1)
+            ciphertext = ciphertext->Clone();
+
+        return ciphertext;
+    }
+
+    /***
+     * Moves the ciphertext out of the object, so it can be freed as soon as the receiver is done with it.
+     *
+     * @return The ciphertext
+     */
+    Cipher takeCiphertext () {
+        return std::move(ciphertext);
+    }
+
     /***
      * Method that allows a ciphertexts to be serialized from a file.
      *
@@ -32,13 +55,85 @@ public:
      * Method that allows serialization of a ciphertext.
      *
      * @param filePath
+     * @param compress Whether a compacted copy of the ciphertext is written, the ciphertext itself keeps all limbs
+     * @param towers Number of RNS limbs that are kept when compressing
+     * @return Number of bytes saved by the compression
      */
-    void save(std::string filePath) {
-        if(!Serial::SerializeToFile(filePath, ciphertext, SerType::BINARY)) {
+    uint64_t save(std::string filePath, bool compress=false, uint32_t towers=1) {
+        if (compress && towers == 0)
+            throw std::invalid_argument("At least one RNS limb has to be kept.");
+
+        Cipher written = ciphertext;
+        uint64_t saved = 0;
+        if (compress) {
+            written = ciphertext->GetCryptoContext()->Compress(ciphertext->Clone(), towers);
+            saved = getMemorySize() - std::min(getMemorySize(), GetMemorySize(written));
+        }
+
+        if(!Serial::SerializeToFile(filePath, written, SerType::BINARY)) {
             std::cerr << "Error Serializing ciphertext." << std::endl;
             exit(1);
         }
-        std::cout << "Ciphertext serialized." << std::endl;
+        if (compress)
+            std::cout << "Ciphertext serialized, compression saved " << saved << " bytes." << std::endl;
+        else
+            std::cout << "Ciphertext serialized." << std::endl;
+
+        return saved;
+    }
+
+    /***
+     * Drops all RNS limbs of the ciphertext that are not needed for decryption, rescaling it first if necessary. The
+     * ciphertext can afterwards only be used for towers - 1 more multiplications, so a result should be compacted to a
+     * single limb, while a fresh input should keep one limb more than the depth of the model evaluated on it.
+     *
+     * @param towers Number of RNS limbs that are kept
+     * @return Number of bytes saved
+     */
+    uint64_t compact(uint32_t towers=1) {
+        if (towers == 0)
+            throw std::invalid_argument("At least one RNS limb has to be kept.");
+
+        uint64_t before = getMemorySize();
+        ciphertext = ciphertext->GetCryptoContext()->Compress(ciphertext, towers);
+
+        return before - std::min(before, getMemorySize());
+    }
+
+    /***
+     * Getter Method for the number of RNS limbs of the ciphertext.
+     *
+     * @return Number of RNS limbs
+     */
+    uint32_t getTowers() {
+        return ciphertext->GetElements()[0].GetNumOfElements();
+    }
+
+    /***
+     * Getter Method for the number of levels already consumed by the ciphertext.
+     *
+     * @return Level
+     */
+    uint32_t getLevel() {
+        return ciphertext->GetLevel();
+    }
+
+    /***
+     * Number of bytes the binary serialization of the ciphertext takes.
+     *
+     * @return Size in bytes
+     */
+    uint64_t getSerializedSize() {
+        return GetSerializedSize(ciphertext);
+    }
+
+    /***
+     * Size of the RNS limbs of all ciphertext elements in memory.
+     *
+     * @return Size in bytes
+     */
+    uint64_t getMemorySize() const {
+        return GetMemorySize(ciphertext);
     }
 
     /***
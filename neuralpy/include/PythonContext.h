@@ -7,6 +7,7 @@
 
 #include "OpenFHEPrerequisites.h"
 
+#include "MemoryAccounting.h"
 #include "PythonCiphertext.h"
 #include "PythonKeys.h"
 
@@ -32,7 +33,7 @@ public:
         context->EvalMultKeyGen(privateKey.getKey());
     }
 
-    PythonCiphertext EvalAdd (PythonCiphertext a, PythonCiphertext b) {
+    PythonCiphertext EvalAdd (const PythonCiphertext& a, const PythonCiphertext& b) {
         PythonCiphertext result;
         Cipher ciph_result = context->EvalAdd(a.getCiphertext(), b.getCiphertext());
         result.setCiphertext(ciph_result);
@@ -40,7 +41,7 @@ public:
         return result;
     }
 
-    PythonCiphertext EvalAdd (std::vector<double> a, PythonCiphertext b) {
+    PythonCiphertext EvalAdd (const std::vector<double>& a, const PythonCiphertext& b) {
         PythonCiphertext result;
         Plaintext pl = context->MakeCKKSPackedPlaintext(a);
         Cipher ciph_result = context->EvalAdd(pl, b.getCiphertext());
@@ -49,7 +50,7 @@ public:
         return result;
     }
 
-    PythonCiphertext EvalAdd (double a, PythonCiphertext b) {
+    PythonCiphertext EvalAdd (double a, const PythonCiphertext& b) {
         PythonCiphertext result;
         Cipher ciph_result = context->EvalAdd(a, b.getCiphertext());
         result.setCiphertext(ciph_result);
@@ -57,7 +58,7 @@ public:
         return result;
     }
 
-    PythonCiphertext EvalSub (PythonCiphertext a, PythonCiphertext b) {
+    PythonCiphertext EvalSub (const PythonCiphertext& a, const PythonCiphertext& b) {
         PythonCiphertext result;
         Cipher ciph_result = context->EvalSub(a.getCiphertext(), b.getCiphertext());
         result.setCiphertext(ciph_result);
@@ -65,7 +66,7 @@ public:
         return result;
     }
 
-    PythonCiphertext EvalSub (std::vector<double> a, PythonCiphertext b, bool reverse=false) {
+    PythonCiphertext EvalSub (const std::vector<double>& a, const PythonCiphertext& b, bool reverse=false) {
         PythonCiphertext result;
         Plaintext pl = context->MakeCKKSPackedPlaintext(a);
         Cipher ciph_result;
@@ -79,7 +80,7 @@ public:
         return result;
     }
 
-    PythonCiphertext EvalSub (double a, PythonCiphertext b, bool reverse=false) {
+    PythonCiphertext EvalSub (double a, const PythonCiphertext& b, bool reverse=false) {
         PythonCiphertext result;
         Cipher ciph_result;
         if (!reverse) {
@@ -99,7 +100,7 @@ public:
      * @param b
      * @return
      */
-    PythonCiphertext EvalMult (PythonCiphertext a, PythonCiphertext b) {
+    PythonCiphertext EvalMult (const PythonCiphertext& a, const PythonCiphertext& b) {
         PythonCiphertext result;
         Cipher ciph_result = context->EvalMult(a.getCiphertext(), b.getCiphertext());
         result.setCiphertext(ciph_result);
@@ -114,7 +115,7 @@ public:
      * @param b
      * @return
      */
-    PythonCiphertext EvalMult (std::vector<double> a, PythonCiphertext b) {
+    PythonCiphertext EvalMult (const std::vector<double>& a, const PythonCiphertext& b) {
         PythonCiphertext result;
         Plaintext pl = context->MakeCKKSPackedPlaintext(a);
         Cipher ciph_result = context->EvalMult(pl, b.getCiphertext());
@@ -130,7 +131,7 @@ public:
      * @param b
      * @return
      */
-    PythonCiphertext EvalMult (double a, PythonCiphertext b) {
+    PythonCiphertext EvalMult (double a, const PythonCiphertext& b) {
         PythonCiphertext result;
         Cipher ciph_result = context->EvalMult(a, b.getCiphertext());
         result.setCiphertext(ciph_result);
@@ -138,13 +139,113 @@ public:
         return result;
     }
 
+    /***
+     * In place addition of ciphertext b to ciphertext a.
+     *
+     * @param a Ciphertext holding the result
+     * @param b
+     */
+    void EvalAddInPlace (PythonCiphertext& a, const PythonCiphertext& b) {
+        context->EvalAddInPlace(a.getMutableCiphertext(), b.getCiphertext());
+    }
+
+    /***
+     * In place addition of plaintext b to ciphertext a.
+     *
+     * @param a Ciphertext holding the result
+     * @param b
+     */
+    void EvalAddInPlace (PythonCiphertext& a, const std::vector<double>& b) {
+        Plaintext pl = context->MakeCKKSPackedPlaintext(b);
+        context->EvalAddInPlace(a.getMutableCiphertext(), pl);
+    }
+
+    /***
+     * In place addition of a floating point number b to ciphertext a.
+     *
+     * @param a Ciphertext holding the result
+     * @param b
+     */
+    void EvalAddInPlace (PythonCiphertext& a, double b) {
+        context->EvalAddInPlace(a.getMutableCiphertext(), b);
+    }
+
+    /***
+     * In place subtraction of ciphertext b from ciphertext a.
+     *
+     * @param a Ciphertext holding the result
+     * @param b
+     */
+    void EvalSubInPlace (PythonCiphertext& a, const PythonCiphertext& b) {
+        context->EvalSubInPlace(a.getMutableCiphertext(), b.getCiphertext());
+    }
+
+    /***
+     * In place subtraction of plaintext b from ciphertext a.
+     *
+     * @param a Ciphertext holding the result
+     * @param b
+     */
+    void EvalSubInPlace (PythonCiphertext& a, const std::vector<double>& b) {
+        Plaintext pl = context->MakeCKKSPackedPlaintext(b);
+        context->EvalSubInPlace(a.getMutableCiphertext(), pl);
+    }
+
+    /***
+     * In place subtraction of a floating point number b from ciphertext a.
+     *
+     * @param a Ciphertext holding the result
+     * @param b
+     */
+    void EvalSubInPlace (PythonCiphertext& a, double b) {
+        context->EvalSubInPlace(a.getMutableCiphertext(), b);
+    }
+
+    /***
+     * In place multiplication of ciphertext a with ciphertext b. Ciphertext b may be brought to the level of a, which
+     * does not change the value it decrypts to.
+     *
+     * @param a Ciphertext holding the result
+     * @param b
+     */
+    void EvalMultInPlace (PythonCiphertext& a, PythonCiphertext& b) {
+        if (&a == &b)
+            context->EvalSquareInPlace(a.getMutableCiphertext());
+        else
+            context->EvalMultMutableInPlace(a.getMutableCiphertext(), b.getMutableCiphertext());
+    }
+
+    /***
+     * In place multiplication of ciphertext a with a floating point number b.
+     *
+     * @param a Ciphertext holding the result
+     * @param b
+     */
+    void EvalMultInPlace (PythonCiphertext& a, double b) {
+        context->EvalMultInPlace(a.getMutableCiphertext(), b);
+    }
+
+    /***
+     * Rescale a ciphertext in place, only needed for the FIXEDMANUAL scaling technique.
+     *
+     * @param a
+     */
+    void RescaleInPlace (PythonCiphertext& a) {
+        context->RescaleInPlace(a.getMutableCiphertext());
+    }
+
     /***
      * Generate rotation keys required to do matrix multiplication with the contexts batch size.
      *
      * @param key
+     * @param indices Additional rotation indices, e.g. the ones of a PackedConv2D
      */
-    void GenRotations (PythonKey<PrivateKey<DCRTPoly>> key) {
+    void GenRotations (PythonKey<PrivateKey<DCRTPoly>> key, std::vector<int32_t> indices={}) {
         std::vector<int> rotations = GetRotations(context->GetEncodingParams()->GetBatchSize());
+        for (int32_t index : indices)
+            if (std::find(rotations.begin(), rotations.end(), index) == rotations.end())
+                rotations.push_back(index);
+
         context->EvalRotateKeyGen(key.getKey(), rotations);
     }
 
@@ -195,14 +296,17 @@ public:
     }
 
     /***
-     * Packing a C++ iterator containing doubles into a plaintext object.
+     * Packing a C++ iterator containing doubles into a plaintext object. Encrypting a plaintext with a level larger than
+     * zero yields a smaller ciphertext with fewer RNS limbs, which is useful for inputs of models that do not need the
+     * whole modulus chain.
      *
      * @param plaintext Plaintext in form of a C++ iterator
+     * @param level Level at which the plaintext is encoded
      * @return Plaintext object
      */
-    PythonPlaintext PackPlaintext(std::vector<double> plaintext) {
+    PythonPlaintext PackPlaintext(std::vector<double> plaintext, uint32_t level=0) {
         PythonPlaintext result;
-        result.setPlaintext(context->MakeCKKSPackedPlaintext(plaintext));
+        result.setPlaintext(context->MakeCKKSPackedPlaintext(plaintext, 1, level));
         return result;
     }
 
@@ -332,6 +436,24 @@ public:
         }
     }
 
+    /***
+     * Memory used by the multiplication keys of this context.
+     *
+     * @return Map with the serialized size and memory size in bytes and the number of keys
+     */
+    std::map<std::string, uint64_t> GetMultKeyUsage() {
+        return ::GetMultKeyUsage(context);
+    }
+
+    /***
+     * Memory used by the rotation keys of this context.
+     *
+     * @return Map with the serialized size and memory size in bytes and the number of keys
+     */
+    std::map<std::string, uint64_t> GetRotationKeyUsage() {
+        return ::GetRotationKeyUsage(context);
+    }
+
 private:
     Context context;
 };
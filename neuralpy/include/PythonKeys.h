@@ -1,7 +1,11 @@
 #ifndef NEURALPY_PYTHONKEYS_H
 #define NEURALPY_PYTHONKEYS_H
 
+#include <stdexcept>
+#include <type_traits>
+
 #include "OpenFHEPrerequisites.h"
+#include "MemoryAccounting.h"
 
 
 /***
@@ -39,6 +43,27 @@ public:
         std::cout << "Key serialized to " << filePath << "." << std::endl;
     }
 
+    /***
+     * Number of bytes the binary serialization of the key takes.
+     *
+     * @return Size in bytes
+     */
+    uint64_t getSerializedSize() {
+        return GetSerializedSize(key);
+    }
+
+    /***
+     * Size of the polynomials of the key in memory.
+     *
+     * @return Size in bytes
+     */
+    uint64_t getMemorySize() {
+        if constexpr (std::is_same_v<T, PublicKey<DCRTPoly>>)
+            return GetMemorySize(key->GetPublicElements());
+        else
+            return GetMemorySize(key->GetPrivateElement());
+    }
+
 private:
     T key;
 };
@@ -92,7 +117,33 @@ public:
         return pl->GetRealPackedValue();
     }
 
+    /***
+     * Number of bytes the binary serialization of the encoded polynomial takes.
+     *
+     * @return Size in bytes
+     */
+    uint64_t GetSerializedSize () {
+        return ::GetSerializedSize(getEncodedElement());
+    }
+
+    /***
+     * Size of the encoded polynomial in memory.
+     *
+     * @return Size in bytes
+     */
+    uint64_t GetMemorySize () {
+        return ::GetMemorySize(getEncodedElement());
+    }
+
 private:
+    //  A decrypted plaintext only holds the decoded values, its polynomial is allocated but never filled
+    const DCRTPoly& getEncodedElement () {
+        if (!pl->IsEncoded())
+            throw std::logic_error("Plaintext has been decrypted and holds no encoded polynomial.");
+
+        return pl->GetElement<DCRTPoly>();
+    }
+
     Plaintext pl;
 };
 
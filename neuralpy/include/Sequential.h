@@ -0,0 +1,202 @@
+/**
+ * @file Sequential.h
+ *
+ * @brief This file includes a pipeline that applies a list of operators one after another, optionally bound to a
+ * context that is used instead of the global one. Pipelines bound to different contexts can be used from different
+ * threads at the same time. A pipeline can override the number of OpenMP threads each of its operators uses.
+ */
+#ifndef NEURALPY_SEQUENTIAL_H
+#define NEURALPY_SEQUENTIAL_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "NeuralOFHE/NeuralOFHE.h"
+
+#include "ContextBinding.h"
+#include "MemoryAccounting.h"
+#include "PythonCiphertext.h"
+#include "PythonContext.h"
+#include "TaskScheduler.h"
+
+
+/***
+ * Memory recorded after a single operator of a pipeline.
+ */
+struct LayerMemoryUsage {
+    std::string name;
+    double seconds;
+    //  Size of the output ciphertext
+    uint64_t outputBytes;
+    //  Size of the input and the output of the operator, without the context and the keys
+    uint64_t ioBytes;
+    uint64_t residentBytes;
+    //  Peak resident memory during the operator if the peak was reset, otherwise of the whole process
+    uint64_t peakResidentBytes;
+    bool peakIsPerLayer;
+    //  How much the operator raised the peak resident memory of the process
+    uint64_t peakGrowthBytes;
+};
+
+
+class Sequential : public std::enable_shared_from_this<Sequential> {
+public:
+    typedef std::function<void (PythonCiphertext, std::exception_ptr)> Callback;
+
+    /***
+     * Creates a pipeline that uses the global context.
+     *
+     * @param operators Operators in the order they are applied
+     */
+    Sequential(std::vector<std::shared_ptr<Operator>> operators) : operators(operators) {}
+
+    /***
+     * Creates a pipeline bound to a context.
+     *
+     * @param operators Operators in the order they are applied
+     * @param context Context all operators are evaluated under
+     */
+    Sequential(std::vector<std::shared_ptr<Operator>> operators, PythonContext context)
+            : operators(operators), context(context.getContext()) {}
+
+    /***
+     * Applies all operators to the input. Every intermediate result is freed as soon as the next operator is done with
+     * it, unless it is referenced elsewhere.
+     *
+     * @param x Input ciphertext
+     * @return Output ciphertext
+     */
+    PythonCiphertext forward(PythonCiphertext x) {
+        ScopedIntraOpThreads budget(intraOpThreads);
+        Cipher cipher = x.takeCiphertext();
+        for (auto& op : operators)
+            cipher = ForwardInContext(*op, std::move(cipher), context);
+
+        PythonCiphertext result;
+        result.setCiphertext(std::move(cipher));
+        return result;
+    }
+
+    /***
+     * Applies all operators to the input and records the memory after every operator. The input is not changed.
+     * Concurrent work of other threads is included in the resident memory, so it should be run in isolation.
+     *
+     * @param x Input ciphertext
+     * @param resetPeak Whether the peak resident memory of the process is reset before every operator, which also
+     * resets it for everyone else reading it
+     * @return Memory usage of every operator
+     */
+    std::vector<LayerMemoryUsage> Profile(PythonCiphertext x, bool resetPeak=false) {
+        ScopedIntraOpThreads budget(intraOpThreads);
+
+        std::vector<LayerMemoryUsage> usage;
+        Cipher cipher = x.getCiphertext();
+        for (auto& op : operators) {
+            Cipher input = cipher;
+            uint64_t inputBytes = GetMemorySize(input);
+
+            bool perLayer = resetPeak && ResetPeakResidentMemory();
+            uint64_t peakBefore = GetPeakResidentMemory();
+            auto start = std::chrono::steady_clock::now();
+            cipher = ForwardInContext(*op, std::move(cipher), context);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            uint64_t peak = GetPeakResidentMemory();
+
+            uint64_t outputBytes = GetMemorySize(cipher);
+            uint64_t ioBytes = cipher == input ? outputBytes : outputBytes + inputBytes;
+            usage.push_back({op->getName(), seconds, outputBytes, ioBytes, GetResidentMemory(), peak, perLayer,
+                             peak > peakBefore ? peak - peakBefore : 0});
+        }
+
+        return usage;
+    }
+
+    /***
+     * Applies all operators to the input on the TaskScheduler. Every operator runs as a separate task, so successive
+     * requests are pipelined across the layers. Must be called on a pipeline owned by a shared pointer.
+     *
+     * @param x Input ciphertext
+     * @param done Called from a worker thread with the output, or with the exception of the failed operator
+     */
+    void submit(PythonCiphertext x, Callback done) {
+        if (operators.empty()) {
+            TaskScheduler::instance().post([x, done]() { done(x, nullptr); });
+            return;
+        }
+
+        runLayer(shared_from_this(), 0, x.takeCiphertext(), std::move(done));
+    }
+
+    std::vector<std::shared_ptr<Operator>> GetOperators() {
+        return operators;
+    }
+
+    /***
+     * Whether the pipeline is bound to a context or uses the global one.
+     *
+     * @return True if bound
+     */
+    bool IsBound() {
+        return context != nullptr;
+    }
+
+    /***
+     * Context the pipeline is bound to.
+     *
+     * @return Context object
+     */
+    PythonContext GetContext() {
+        if (!context)
+            throw std::logic_error("Pipeline is not bound to a context.");
+
+        PythonContext result;
+        result.SetContext(context);
+        return result;
+    }
+
+    size_t size() {
+        return operators.size();
+    }
+
+    /***
+     * Overrides the global number of OpenMP threads per operation for this pipeline.
+     *
+     * @param count Number of threads, zero to use the global setting
+     */
+    void SetIntraOpThreads(uint32_t count) {
+        intraOpThreads = count;
+    }
+
+    uint32_t GetIntraOpThreads() {
+        return intraOpThreads;
+    }
+
+private:
+    static void runLayer(std::shared_ptr<Sequential> self, size_t layer, Cipher x, Callback done) {
+        TaskScheduler::instance().post([self, layer, x = std::move(x), done = std::move(done)]() mutable {
+            Cipher y;
+            try {
+                ScopedIntraOpThreads budget(self->intraOpThreads);
+                y = ForwardInContext(*self->operators[layer], std::move(x), self->context);
+            } catch (...) {
+                done(PythonCiphertext(), std::current_exception());
+                return;
+            }
+
+            if (layer + 1 < self->operators.size()) {
+                runLayer(self, layer + 1, std::move(y), std::move(done));
+            } else {
+                PythonCiphertext result;
+                result.setCiphertext(y);
+                done(result, nullptr);
+            }
+        });
+    }
+
+    std::vector<std::shared_ptr<Operator>> operators;
+    Context context;
+    std::atomic<uint32_t> intraOpThreads{0};
+};
+
+#endif //NEURALPY_SEQUENTIAL_H
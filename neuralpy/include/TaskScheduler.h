@@ -0,0 +1,243 @@
+/**
+ * @file TaskScheduler.h
+ *
+ * @brief This file includes a work stealing thread pool used to run independent homomorphic operations concurrently.
+ * Every worker owns a queue, tasks posted from a worker go to its own queue and are taken from the back, so
+ * continuations of a request stay on the same core, while idle workers steal from the front of the other queues. The
+ * workers are started lazily on the first task, so the number of threads can be configured before.
+ */
+#ifndef NEURALPY_TASKSCHEDULER_H
+#define NEURALPY_TASKSCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+class TaskScheduler {
+public:
+    /***
+     * @param threads Number of worker threads, the number of hardware threads if zero
+     */
+    explicit TaskScheduler(size_t threads=0) : threadCount(threads) {}
+
+    ~TaskScheduler() {
+        shutdown();
+    }
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /***
+     * Process wide scheduler used by the asynchronous Python API.
+     *
+     * @return Scheduler
+     */
+    static TaskScheduler& instance() {
+        static TaskScheduler scheduler;
+        return scheduler;
+    }
+
+    /***
+     * Queues a task without a result.
+     *
+     * @param task
+     */
+    void post(std::function<void ()> task) {
+        if (current == this) {
+            //  Continuations stay with the worker, which keeps running until all queues are empty, even when stopping
+            std::lock_guard<std::mutex> lock(queues[currentIndex]->mutex);
+            queues[currentIndex]->tasks.push_back(std::move(task));
+            pending++;
+        } else {
+            std::lock_guard<std::mutex> control(controlMutex);
+            start();
+
+            size_t index = next++ % queues.size();
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+            pending++;
+        }
+
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wake.notify_one();
+    }
+
+    /***
+     * Queues a task and returns a future for its result.
+     *
+     * @param task
+     * @return Future holding the result or the exception of the task
+     */
+    template<typename F>
+    auto submit(F task) -> std::future<std::invoke_result_t<F>> {
+        auto packaged = std::make_shared<std::packaged_task<std::invoke_result_t<F> ()>>(std::move(task));
+        auto future = packaged->get_future();
+        post([packaged]() { (*packaged)(); });
+
+        return future;
+    }
+
+    /***
+     * Changes the number of worker threads. Waits for all queued tasks to finish if the workers are running, so the
+     * caller must not hold anything the tasks wait for, e.g. the GIL. Must not be called from a task.
+     *
+     * @param threads Number of worker threads, the number of hardware threads if zero
+     */
+    void resize(size_t threads) {
+        if (current == this)
+            throw std::logic_error("The task scheduler can not be resized from one of its tasks.");
+
+        shutdown();
+
+        std::lock_guard<std::mutex> control(controlMutex);
+        threadCount = threads;
+    }
+
+    /***
+     * Number of worker threads the scheduler runs with.
+     *
+     * @return Number of threads
+     */
+    size_t size() {
+        std::lock_guard<std::mutex> control(controlMutex);
+        return threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    /***
+     * Number of worker threads the scheduler was configured with, which can be passed to resize to restore it.
+     *
+     * @return Number of threads, zero for the number of hardware threads
+     */
+    size_t configuredSize() {
+        std::lock_guard<std::mutex> control(controlMutex);
+        return threadCount;
+    }
+
+    /***
+     * Number of tasks that are queued but not yet started. Changed together with the queues, so a worker only wakes up
+     * if there is a task to take.
+     *
+     * @return Number of tasks
+     */
+    size_t queued() {
+        return pending;
+    }
+
+    /***
+     * Waits for all queued tasks to finish and stops the workers. Posting a new task starts them again.
+     */
+    void shutdown() {
+        std::vector<std::thread> joining;
+        {
+            std::lock_guard<std::mutex> control(controlMutex);
+            if (workers.empty())
+                return;
+
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            joining.swap(workers);
+        }
+
+        for (auto& worker : joining)
+            worker.join();
+
+        std::lock_guard<std::mutex> control(controlMutex);
+        queues.clear();
+        stopping = false;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void ()>> tasks;
+    };
+
+    //  Must be called with the control mutex held
+    void start() {
+        if (!workers.empty())
+            return;
+        if (stopping)
+            throw std::logic_error("Task scheduler is shutting down.");
+
+        size_t count = threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < count; i++)
+            queues.push_back(std::make_unique<Queue>());
+        for (size_t i = 0; i < count; i++)
+            workers.emplace_back([this, i]() { run(i); });
+    }
+
+    bool take(size_t index, std::function<void ()>& task) {
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            if (!queues[index]->tasks.empty()) {
+                task = std::move(queues[index]->tasks.back());
+                queues[index]->tasks.pop_back();
+                pending--;
+                return true;
+            }
+        }
+
+        for (size_t offset = 1; offset < queues.size(); offset++) {
+            Queue& victim = *queues[(index + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                pending--;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void run(size_t index) {
+        current = this;
+        currentIndex = index;
+
+        while (true) {
+            std::function<void ()> task;
+            if (take(index, task)) {
+                task();
+                continue;
+            }
+
+            //  A task counted in pending is always in a queue, so a failed take is only retried for a task posted
+            //  after its queue was searched, instead of spinning while another worker runs the last one
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this]() { return stopping || pending > 0; });
+            if (stopping && pending == 0)
+                break;
+        }
+
+        current = nullptr;
+    }
+
+    static inline thread_local TaskScheduler* current = nullptr;
+    static inline thread_local size_t currentIndex = 0;
+
+    size_t threadCount;
+    std::mutex controlMutex;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> pending{0};
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+#endif //NEURALPY_TASKSCHEDULER_H
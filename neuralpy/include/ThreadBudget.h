@@ -0,0 +1,134 @@
+/**
+ * @file ThreadBudget.h
+ *
+ * @brief This file includes the control of the number of OpenMP threads OpenFHE uses within a single operation (intra
+ * op), as opposed to the number of operations the TaskScheduler runs at the same time (inter op). OpenFHE gives its
+ * parallel loops a num_threads clause limited by the process wide OpenFHEParallelControls, which takes precedence over
+ * the OpenMP thread count of the calling thread, so the global budget is passed to OpenFHEParallelControls.
+ *
+ * A thread local override allows a single call or pipeline to use a different budget. It is applied lazily with
+ * omp_set_num_threads by every thread before it evaluates an operator and therefore only reaches OpenMP regions without
+ * a num_threads clause, e.g. those of NeuralOFHE, while the loops of OpenFHE keep using the global budget.
+ */
+#ifndef NEURALPY_THREADBUDGET_H
+#define NEURALPY_THREADBUDGET_H
+
+#include <atomic>
+#include <cstdint>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "utils/parallel.h"
+
+
+namespace threads {
+    /***
+     * Number of OpenMP threads per operation, zero for the OpenMP default.
+     */
+    std::atomic<uint32_t>& IntraOp() {
+        static std::atomic<uint32_t> threads{0};
+        return threads;
+    }
+
+    /***
+     * Number of OpenMP threads OpenMP would use without any budget, read once when the module is loaded.
+     */
+    uint32_t DefaultIntraOp() {
+#ifdef _OPENMP
+        static const uint32_t threads = omp_get_max_threads();
+        return threads;
+#else
+        return 1;
+#endif
+    }
+
+    /***
+     * Budget override of the calling thread, zero if there is none.
+     */
+    uint32_t& Override() {
+        static thread_local uint32_t threads = 0;
+        return threads;
+    }
+
+    /***
+     * Number of OpenMP threads last applied on the calling thread, zero if none has been applied yet.
+     */
+    uint32_t& Applied() {
+        static thread_local uint32_t threads = 0;
+        return threads;
+    }
+}
+
+
+/***
+ * Number of OpenMP threads the calling thread should use according to its override and the global budget.
+ *
+ * @return Number of threads
+ */
+uint32_t GetEffectiveIntraOpThreads() {
+    if (threads::Override())
+        return threads::Override();
+
+    uint32_t budget = threads::IntraOp();
+    return budget ? budget : threads::DefaultIntraOp();
+}
+
+
+/***
+ * Applies the thread budget to the calling thread if it changed since the last call. Cheap enough to be called before
+ * every operation.
+ */
+void ApplyThreadBudget() {
+    uint32_t target = GetEffectiveIntraOpThreads();
+    if (threads::Applied() == target)
+        return;
+
+#ifdef _OPENMP
+    omp_set_num_threads(target);
+#endif
+    threads::Applied() = target;
+}
+
+
+/***
+ * Sets the global number of OpenMP threads per operation. Takes effect for OpenFHE operations started afterwards.
+ *
+ * @param count Number of threads, zero for the OpenMP default
+ */
+void SetIntraOpThreads(uint32_t count) {
+    uint32_t defaultThreads = threads::DefaultIntraOp();
+    threads::IntraOp() = count;
+    lbcrypto::OpenFHEParallelControls.SetNumThreads(count ? count : defaultThreads);
+    ApplyThreadBudget();
+}
+
+
+/***
+ * Overrides the thread budget of the calling thread for the lifetime of the object.
+ */
+class ScopedIntraOpThreads {
+public:
+    /***
+     * @param count Number of threads, zero to keep the current budget
+     */
+    explicit ScopedIntraOpThreads(uint32_t count) : previous(threads::Override()) {
+        if (count)
+            threads::Override() = count;
+        ApplyThreadBudget();
+    }
+
+    ~ScopedIntraOpThreads() {
+        threads::Override() = previous;
+        ApplyThreadBudget();
+    }
+
+    ScopedIntraOpThreads(const ScopedIntraOpThreads&) = delete;
+    ScopedIntraOpThreads& operator=(const ScopedIntraOpThreads&) = delete;
+
+private:
+    uint32_t previous;
+};
+
+#endif //NEURALPY_THREADBUDGET_H
@@ -0,0 +1,186 @@
+/**
+ * @file ThreadConfiguration.h
+ *
+ * @brief This file includes the configuration of both levels of parallelism, the OpenMP threads inside an operation
+ * (intra op) and the TaskScheduler threads running independent requests (inter op), and a benchmark that sweeps over
+ * splits of the hardware threads between the two to find the best one for a pipeline.
+ */
+#ifndef NEURALPY_THREADCONFIGURATION_H
+#define NEURALPY_THREADCONFIGURATION_H
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PythonCiphertext.h"
+#include "Sequential.h"
+#include "TaskScheduler.h"
+#include "ThreadBudget.h"
+
+
+/***
+ * Sets the number of threads used on both levels. Changing the number of inter op threads waits for all queued tasks,
+ * which complete their Python futures with the GIL, so it has to be called without holding the GIL.
+ *
+ * @param intraOp OpenMP threads per operation, zero for the OpenMP default, unchanged if empty
+ * @param interOp TaskScheduler threads, zero for the number of hardware threads, unchanged if empty
+ */
+void SetThreads(std::optional<uint32_t> intraOp, std::optional<uint32_t> interOp) {
+    if (interOp && *interOp != TaskScheduler::instance().configuredSize())
+        TaskScheduler::instance().resize(*interOp);
+    //  After the resize, which waited for the queued tasks, so fewer operations see the OpenFHE thread count change
+    if (intraOp)
+        SetIntraOpThreads(*intraOp);
+}
+
+
+/***
+ * Reports the effective thread configuration of the calling thread.
+ *
+ * @return Map with the keys intra_op, openfhe_intra_op, inter_op, hardware and openmp, the latter being one if OpenMP
+ * is available. openfhe_intra_op is the limit OpenFHE applies to its own loops, which ignores overrides.
+ */
+std::map<std::string, uint32_t> GetThreadConfiguration() {
+#ifdef _OPENMP
+    uint32_t openmp = 1;
+#else
+    uint32_t openmp = 0;
+#endif
+
+    return {
+        {"intra_op", GetEffectiveIntraOpThreads()},
+        {"openfhe_intra_op", (uint32_t) lbcrypto::OpenFHEParallelControls.GetThreadLimit(INT32_MAX)},
+        {"inter_op", (uint32_t) TaskScheduler::instance().size()},
+        {"hardware", std::max(1u, std::thread::hardware_concurrency())},
+        {"openmp", openmp}
+    };
+}
+
+
+/***
+ * Overrides the number of OpenMP threads per operation of the calling thread between enter and exit, used as a Python
+ * context manager. Work running on the TaskScheduler is not affected, nor are the loops of OpenFHE, see ThreadBudget.h.
+ */
+class ThreadBudgetScope {
+public:
+    /***
+     * @param intraOp OpenMP threads per operation
+     */
+    explicit ThreadBudgetScope(uint32_t intraOp) : intraOp(intraOp) {}
+
+    void enter() {
+        previous.push_back(threads::Override());
+        threads::Override() = intraOp;
+        ApplyThreadBudget();
+    }
+
+    void exit() {
+        if (previous.empty())
+            throw std::logic_error("Thread budget scope has not been entered.");
+
+        threads::Override() = previous.back();
+        previous.pop_back();
+        ApplyThreadBudget();
+    }
+
+private:
+    uint32_t intraOp;
+    std::vector<uint32_t> previous;
+};
+
+
+struct ThreadBenchmarkResult {
+    uint32_t intraOp;
+    uint32_t interOp;
+    double meanLatency;
+    double medianLatency;
+    double maxLatency;
+    double throughput;
+};
+
+
+/***
+ * Runs a pipeline under different thread configurations. For every configuration all requests are submitted at once,
+ * so the inter op threads are saturated. The previous configuration is restored afterwards. Must not be called from a
+ * task.
+ *
+ * @param model Pipeline to run
+ * @param x Input ciphertext used for every request
+ * @param requests Number of concurrent requests per configuration
+ * @param configurations Pairs of intra op and inter op threads, if empty every power of two split of the hardware
+ * threads is used
+ * @return Latencies in seconds and throughput in requests per second for every configuration
+ */
+std::vector<ThreadBenchmarkResult> BenchmarkThreads(std::shared_ptr<Sequential> model, PythonCiphertext x,
+                                                    uint32_t requests=16,
+                                                    std::vector<std::pair<uint32_t, uint32_t>> configurations={}) {
+    typedef std::chrono::steady_clock Clock;
+
+    if (requests == 0)
+        throw std::invalid_argument("At least one request is needed.");
+
+    uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    if (configurations.empty()) {
+        for (uint32_t interOp = 1; interOp <= hardware; interOp *= 2)
+            configurations.emplace_back(std::max(1u, hardware / interOp), interOp);
+    }
+
+    uint32_t previousIntraOp = threads::IntraOp();
+    //  The configured values, so a zero meaning the default stays the default
+    uint32_t previousInterOp = TaskScheduler::instance().configuredSize();
+
+    //  Warm up lazily computed state such as polynomial coefficients, which would distort the first configuration
+    model->forward(x);
+
+    std::vector<ThreadBenchmarkResult> results;
+    std::exception_ptr failure;
+    for (auto& configuration : configurations) {
+        SetThreads(configuration.first, configuration.second);
+
+        std::vector<double> latencies(requests);
+        std::atomic<uint32_t> remaining(requests);
+        std::promise<void> finished;
+        std::future<void> allDone = finished.get_future();
+        std::mutex failureMutex;
+
+        auto start = Clock::now();
+        for (uint32_t i = 0; i < requests; i++) {
+            auto submitted = Clock::now();
+            model->submit(x, [&, i, submitted](PythonCiphertext, std::exception_ptr error) {
+                latencies[i] = std::chrono::duration<double>(Clock::now() - submitted).count();
+                if (error) {
+                    std::lock_guard<std::mutex> lock(failureMutex);
+                    failure = error;
+                }
+                if (--remaining == 0)
+                    finished.set_value();
+            });
+        }
+        allDone.wait();
+        double total = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (failure)
+            break;
+
+        std::sort(latencies.begin(), latencies.end());
+        double sum = 0;
+        for (double latency : latencies)
+            sum += latency;
+
+        results.push_back({configuration.first, configuration.second, sum / requests, latencies[requests / 2],
+                           latencies.back(), requests / total});
+    }
+
+    SetThreads(previousIntraOp, previousInterOp);
+    if (failure)
+        std::rethrow_exception(failure);
+
+    return results;
+}
+
+#endif //NEURALPY_THREADCONFIGURATION_H
@@ -22,6 +22,8 @@
 typedef CCParams<CryptoContextCKKSRNS> Parameters;
 typedef CryptoContext<DCRTPoly> Context;
 
+#include "ContextBinding.h"
+#include "PolynomialApproximation.h"
 #include "PythonCiphertext.h"
 #include "PythonContext.h"
 #include "PythonKeys.h"
@@ -57,6 +59,39 @@ public:
     }
 };
 
+/***
+ * NeuralOFHE activation function that evaluates Chebyshev coefficients taken from the CoefficientCache instead of
+ * fitting them on every forward call. Every instance is a separate operator, only the coefficients are shared. The
+ * series is evaluated with the context of the input, so unlike the NeuralOFHE implementation it is context free.
+ *
+ * @tparam Impl NeuralOFHE activation function
+ */
+template <class Impl> class CachedActivation : public Impl, public ContextFree {
+public:
+    /***
+     * @param function Name of the function, used as part of the cache key
+     * @param lower Lower bound of the interval
+     * @param upper Upper bound of the interval
+     * @param degree Degree of the approximation
+     */
+    CachedActivation(const std::string& function, double lower, double upper, uint32_t degree)
+            : Impl(lower, upper, degree), lower(lower), upper(upper) {
+        //  Mode -1 keeps the key apart from the approximations of PolynomialActivation
+        CoefficientCache::Key key(function, -1, lower, upper, degree, 1);
+        coefficients = CoefficientCache::instance().get(key, [&]() {
+            return Approximation{{ChebyshevCoefficients(this->getFunc(), lower, upper, degree)}};
+        }).coefficients[0];
+    }
+
+    Ciphertext<DCRTPoly> forward (Ciphertext<DCRTPoly> x) override {
+        return x->GetCryptoContext()->EvalChebyshevSeries(x, coefficients, lower, upper);
+    }
+
+private:
+    double lower, upper;
+    std::vector<double> coefficients;
+};
+
 /***
  * Implementation of the activation function class that overrides the forward function. There is no requirement to
  * create a trampoline for the getFunc method since this is a protected method.
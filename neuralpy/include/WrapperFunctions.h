@@ -11,17 +11,24 @@
 #ifndef NEURALPY_WRAPPERFUNCTIONS_H
 #define NEURALPY_WRAPPERFUNCTIONS_H
 
+#include <pybind11/numpy.h>
+
 #include "WrapperClasses.h"
+#include "PolynomialActivation.h"
+#include "PackedConv2D.h"
+#include "ContextBinding.h"
 #include "NeuralOFHE/NeuralOFHE.h"
 
+namespace py = pybind11;
+
 
 /***
- * Python function to set the context variable.
+ * Python function to set the context variable, which is used by all operators that are not bound to a context.
  *
  * @param context
  */
 void SetPythonContext (PythonContext context) {
-    SetContext(context.getContext());
+    SetDefaultContext(context.getContext());
 }
 
 
@@ -55,4 +62,153 @@ PythonContext GetContext(PythonCiphertext cipher) {
 }
 
 
+/***
+ * Calls a vectorized Python function once on all given points.
+ *
+ * @param func Python callable mapping a NumPy array to a NumPy array of the same size
+ * @param points Points at which the function is evaluated
+ * @return Function values
+ */
+std::vector<double> SampleVectorized(const py::function& func, const std::vector<double>& points) {
+    py::array_t<double> input(points.size(), points.data());
+    auto output = py::array_t<double, py::array::c_style | py::array::forcecast>::ensure(func(input));
+
+    if (!output || static_cast<size_t>(output.size()) != points.size())
+        throw std::invalid_argument("Activation function must return one value per input.");
+
+    return {output.data(), output.data() + output.size()};
+}
+
+
+/***
+ * Fits a Chebyshev approximation to a vectorized Python function, e.g. a NumPy ufunc. The function is called once for
+ * all Chebyshev nodes and once on a grid for the error bound, the resulting activation does not keep a reference to it.
+ *
+ * @param func Python callable mapping a NumPy array to a NumPy array of the same size
+ * @param lower Lower bound of the interval the inputs are expected in
+ * @param upper Upper bound of the interval the inputs are expected in
+ * @param degree Degree of the polynomial
+ * @param mode Evaluation mode, one of the Chebyshev modes
+ * @return Activation holding the fitted coefficients
+ */
+PolynomialActivation FitPythonActivation(py::function func, double lower, double upper, uint32_t degree,
+                                         ApproximationMode mode) {
+    if (mode == ApproximationMode::COMPOSITE || mode == ApproximationMode::SQUARE)
+        throw std::invalid_argument("Python functions can only be fitted with a Chebyshev mode.");
+
+    auto coefficients = ChebyshevCoefficientsFromSamples(SampleVectorized(func, ChebyshevNodes(lower, upper, degree)));
+
+    const uint32_t samples = 4096;
+    std::vector<double> grid(samples);
+    for (uint32_t i = 0; i < samples; i++)
+        grid[i] = lower + (upper - lower) * i / (samples - 1);
+
+    auto values = SampleVectorized(func, grid);
+    double maxError = 0;
+    for (uint32_t i = 0; i < samples; i++)
+        maxError = std::max(maxError, std::abs(values[i] - EvalChebyshevPlain(coefficients, lower, upper, grid[i])));
+
+    return {{coefficients}, lower, upper, mode, "custom", 1, maxError};
+}
+
+
+/***
+ * Remove all coefficients from the process wide activation coefficient cache.
+ */
+void ClearCoefficientCache() {
+    CoefficientCache::instance().clear();
+}
+
+
+/***
+ * Number of approximations stored in the process wide activation coefficient cache.
+ *
+ * @return Number of cached approximations
+ */
+size_t GetCoefficientCacheSize() {
+    return CoefficientCache::instance().size();
+}
+
+
+/***
+ * Geometry of a convolution from the shape of its input.
+ *
+ * @param inputShape (channels, height, width) or (height, width) for a single channel
+ * @return Geometry without the output channels and kernel size
+ */
+convolution::Geometry InputGeometry(std::vector<uint32_t> inputShape, uint32_t stride, uint32_t padding) {
+    if (inputShape.size() == 2)
+        inputShape.insert(inputShape.begin(), 1);
+    if (inputShape.size() != 3)
+        throw std::invalid_argument("Expected an input shape of (channels, height, width).");
+
+    convolution::Geometry geometry{};
+    geometry.inChannels = inputShape[0];
+    geometry.height = inputShape[1];
+    geometry.width = inputShape[2];
+    geometry.stride = stride;
+    geometry.padding = padding;
+
+    return geometry;
+}
+
+
+/***
+ * Python factory for a PackedConv2D from a kernel array.
+ *
+ * @param kernel Array of shape (out channels, in channels, kernel height, kernel width)
+ * @param bias One value per output channel or per output
+ * @param inputShape (channels, height, width) or (height, width)
+ * @param stride
+ * @param padding Zero padding on every side
+ * @return Operator
+ */
+std::shared_ptr<PackedConv2D> MakePackedConv2D(py::array_t<double, py::array::c_style | py::array::forcecast> kernel,
+                                               std::vector<double> bias, std::vector<uint32_t> inputShape,
+                                               uint32_t stride, uint32_t padding) {
+    if (kernel.ndim() != 4)
+        throw std::invalid_argument("Expected a kernel of shape (out_channels, in_channels, height, width).");
+
+    convolution::Geometry geometry = InputGeometry(inputShape, stride, padding);
+    if (kernel.shape(1) != geometry.inChannels)
+        throw std::invalid_argument("Kernel and input have a different number of channels.");
+
+    geometry.outChannels = kernel.shape(0);
+    geometry.kernelHeight = kernel.shape(2);
+    geometry.kernelWidth = kernel.shape(3);
+
+    std::vector<double> weights(kernel.data(), kernel.data() + kernel.size());
+    return std::make_shared<PackedConv2D>(weights, bias, geometry);
+}
+
+
+/***
+ * Python factory for a PackedConv2D from the unrolled matrix of a square kernel, e.g. _Conv_0_weights.npy of the
+ * cryptonet example with input_shape=(32, 32), kernel_size=5 and stride=3.
+ *
+ * @param weights Matrix of shape (inputs, outputs)
+ * @param bias One value per output channel or per output
+ * @param inputShape (channels, height, width) or (height, width)
+ * @param kernelSize Height and width of the kernel
+ * @param stride
+ * @param padding Zero padding on every side
+ * @return Operator
+ */
+std::shared_ptr<PackedConv2D> PackedConv2DFromMatrix(matVec weights, std::vector<double> bias,
+                                                     std::vector<uint32_t> inputShape, uint32_t kernelSize,
+                                                     uint32_t stride, uint32_t padding) {
+    convolution::Geometry geometry = InputGeometry(inputShape, stride, padding);
+    geometry.kernelHeight = kernelSize;
+    geometry.kernelWidth = kernelSize;
+    geometry.outChannels = 1;
+    geometry.validate();
+
+    uint32_t perChannel = geometry.outHeight() * geometry.outWidth();
+    if (weights.empty() || weights[0].size() % perChannel != 0)
+        throw std::invalid_argument("The number of outputs is not a multiple of the output size of a channel.");
+    geometry.outChannels = weights[0].size() / perChannel;
+
+    return std::make_shared<PackedConv2D>(weights, bias, geometry);
+}
+
 #endif //NEURALPY_WRAPPERFUNCTIONS_H
@@ -12,7 +12,17 @@ PYBIND11_MODULE(neuralpy, m) {
     defineEnums(m);
     defineBasicOpenFHEModules(m);
     defineNeuralOFHETypes(m);
+    defineDatasetModules(m);
+    defineSequential(m);
+    defineThreading(m);
     m.def("SetContext", &SetPythonContext, py::arg("context"));
     m.def("MakeContext", &MakeContext, py::arg("parameters"));
     m.def("GetContext", &GetContext, py::arg("ciphertext"));
+    m.def("ClearCoefficientCache", &ClearCoefficientCache);
+    m.def("GetCoefficientCacheSize", &GetCoefficientCacheSize);
+    m.def("GetResidentMemory", &GetResidentMemory);
+    m.def("GetPeakResidentMemory", &GetPeakResidentMemory);
+    m.def("GetSchedulerThreads", []() { return TaskScheduler::instance().size(); });
+
+    py::module_::import("atexit").attr("register")(py::cpp_function(&ShutdownScheduler));
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+/**
+ * @file test_context_binding.cpp
+ *
+ * @brief Tests of the WriterPreferringMutex guarding the global NeuralOFHE context: a waiting writer keeps new readers
+ * out and is not starved by a steady stream of readers.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "ContextBinding.h"
+
+
+static int failures = 0;
+
+static void Check(bool condition, const char* message) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", message);
+        failures++;
+    }
+}
+
+
+/***
+ * A reader arriving while a writer waits only gets the lock after the writer released it.
+ */
+static void TestWaitingWriterBlocksNewReaders() {
+    binding::WriterPreferringMutex mutex;
+    std::atomic<bool> writerDone{false}, readerAcquired{false}, readerAfterWriter{false};
+
+    mutex.lock_shared();
+
+    std::thread writer([&]() {
+        mutex.lock();
+        writerDone = true;
+        mutex.unlock();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::thread reader([&]() {
+        mutex.lock_shared();
+        readerAcquired = true;
+        readerAfterWriter = writerDone.load();
+        mutex.unlock_shared();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    Check(!writerDone, "writer waits for the active reader");
+    Check(!readerAcquired, "new reader waits behind the waiting writer");
+
+    mutex.unlock_shared();
+    writer.join();
+    reader.join();
+
+    Check(readerAfterWriter, "new reader gets the lock after the writer");
+}
+
+
+/***
+ * Writers get the lock in bounded time while readers keep overlapping, which never leaves the lock free with the
+ * reader preferring std::shared_mutex of glibc.
+ */
+static void TestWriterNotStarved() {
+    binding::WriterPreferringMutex mutex;
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 8; i++) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                mutex.lock_shared();
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                mutex.unlock_shared();
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20; i++) {
+        mutex.lock();
+        mutex.unlock();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    done = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    Check(seconds < 5, "20 writers get the lock between a steady stream of readers");
+}
+
+
+int main() {
+    TestWaitingWriterBlocksNewReaders();
+    TestWriterNotStarved();
+
+    if (failures == 0)
+        std::printf("All context binding tests passed.\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file test_packed_conv2d.cpp
+ *
+ * @brief Tests of the baby step giant step plan of PackedConv2D. The plan is evaluated on plaintext vectors with the
+ * same cyclic rotations and masks the operator applies to a ciphertext and compared to a direct convolution.
+ */
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "PackedConv2D.h"
+
+
+static int failures = 0;
+
+static void Check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", message.c_str());
+        failures++;
+    }
+}
+
+
+/***
+ * Cyclic rotation to the left, as EvalRotate with a positive index.
+ */
+static std::vector<double> Rotate(const std::vector<double>& values, int32_t index) {
+    size_t n = values.size();
+    std::vector<double> result(n);
+    for (size_t i = 0; i < n; i++)
+        result[i] = values[convolution::Modulo((int64_t) i + index, n)];
+
+    return result;
+}
+
+
+/***
+ * Evaluates a plan like PackedConv2D::forward: every baby step rotates the input, the rotated copies are multiplied
+ * with the masks and summed per giant step, which then rotates the sum to the outputs.
+ */
+static std::vector<double> EvalPlan(const convolution::Plan& plan, const std::vector<double>& x) {
+    std::vector<double> result(plan.slots, 0.0);
+    for (auto& giant : plan.masks) {
+        std::vector<double> gathered(plan.slots, 0.0);
+        for (auto& term : giant.second) {
+            std::vector<double> rotated = Rotate(x, term.first);
+            for (uint32_t i = 0; i < plan.slots; i++)
+                gathered[i] += term.second[i] * rotated[i];
+        }
+
+        std::vector<double> moved = Rotate(gathered, giant.first);
+        for (uint32_t i = 0; i < plan.slots; i++)
+            result[i] += moved[i];
+    }
+
+    return result;
+}
+
+
+/***
+ * Convolution of an input packed channel by channel with a kernel of shape (out channels, in channels, kernel height,
+ * kernel width), computed directly from the definition.
+ */
+static std::vector<double> DirectConvolution(const convolution::Geometry& g, const std::vector<double>& kernel,
+                                             const std::vector<double>& x) {
+    uint32_t oh = g.outHeight(), ow = g.outWidth();
+    std::vector<double> result(g.outputs(), 0.0);
+    for (uint32_t o = 0; o < g.outChannels; o++)
+    for (uint32_t oy = 0; oy < oh; oy++)
+    for (uint32_t ox = 0; ox < ow; ox++)
+    for (uint32_t c = 0; c < g.inChannels; c++)
+    for (uint32_t dy = 0; dy < g.kernelHeight; dy++)
+    for (uint32_t dx = 0; dx < g.kernelWidth; dx++) {
+        int64_t iy = (int64_t) oy * g.stride + dy - g.padding;
+        int64_t ix = (int64_t) ox * g.stride + dx - g.padding;
+        if (iy < 0 || ix < 0 || iy >= g.height || ix >= g.width)
+            continue;
+
+        double weight = kernel[((o * g.inChannels + c) * g.kernelHeight + dy) * g.kernelWidth + dx];
+        result[(o * oh + oy) * ow + ox] += weight * x[(c * g.height + iy) * g.width + ix];
+    }
+
+    return result;
+}
+
+
+/***
+ * Compares the plan of a kernel and of the same kernel unrolled into a matrix with the direct convolution, and checks
+ * that the reported number of rotations matches the steps of the plan.
+ */
+static void TestGeometry(const convolution::Geometry& g, uint32_t slots) {
+    std::string name = std::to_string(g.inChannels) + "x" + std::to_string(g.height) + "x" + std::to_string(g.width) +
+                       " kernel " + std::to_string(g.kernelHeight) + " stride " + std::to_string(g.stride) +
+                       " padding " + std::to_string(g.padding) + " slots " + std::to_string(slots);
+
+    std::mt19937 generator(1);
+    std::normal_distribution<double> normal;
+    std::vector<double> kernel((size_t) g.outChannels * g.inChannels * g.kernelHeight * g.kernelWidth);
+    for (double& weight : kernel)
+        weight = normal(generator);
+    std::vector<double> x(slots, 0.0);
+    for (uint32_t i = 0; i < g.inputs(); i++)
+        x[i] = normal(generator);
+
+    std::vector<double> expected = DirectConvolution(g, kernel, x);
+
+    matVec matrix(g.inputs(), std::vector<double>(g.outputs(), 0.0));
+    for (auto& tap : convolution::TapsFromKernel(g, kernel))
+        matrix[tap.input][tap.output] += tap.weight;
+
+    for (auto taps : {convolution::TapsFromKernel(g, kernel), convolution::TapsFromMatrix(g, matrix)}) {
+        convolution::Plan plan = convolution::MakePlan(g, taps, slots);
+        std::vector<double> y = EvalPlan(plan, x);
+
+        double error = 0;
+        for (uint32_t i = 0; i < slots; i++)
+            error = std::max(error, std::abs(y[i] - (i < g.outputs() ? expected[i] : 0.0)));
+        Check(error < 1e-9, name + ": plan matches the direct convolution, error " + std::to_string(error));
+
+        uint32_t rotations = 0;
+        for (int32_t baby : plan.babySteps)
+            rotations += baby != 0;
+        for (auto& giant : plan.masks)
+            rotations += giant.first != 0;
+        Check(rotations == plan.rotations, name + ": rotation count matches the plan");
+    }
+}
+
+
+int main() {
+    TestGeometry({1, 32, 32, 4, 5, 5, 3, 0}, 1024);
+    TestGeometry({4, 8, 8, 8, 3, 3, 1, 1}, 1024);
+    TestGeometry({2, 16, 16, 4, 3, 3, 2, 1}, 1024);
+    TestGeometry({3, 8, 8, 2, 3, 3, 1, 0}, 256);
+
+    if (failures == 0)
+        std::printf("All packed convolution tests passed.\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file test_task_scheduler.cpp
+ *
+ * @brief Tests of the work stealing TaskScheduler: continuations posted from a worker, stealing by idle workers and
+ * shutting down while tasks are still queued.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include "TaskScheduler.h"
+
+
+static int failures = 0;
+
+static void Check(bool condition, const char* message) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", message);
+        failures++;
+    }
+}
+
+
+/***
+ * A chain of continuations, each posted from the task before it, runs to the end.
+ */
+static void TestPostFromWorker() {
+    TaskScheduler scheduler(4);
+
+    std::promise<int> done;
+    std::function<void (int)> step = [&](int k) {
+        if (k == 1000) {
+            done.set_value(k);
+            return;
+        }
+        scheduler.post([&step, k]() { step(k + 1); });
+    };
+    scheduler.post([&step]() { step(0); });
+
+    auto result = done.get_future();
+    Check(result.wait_for(std::chrono::seconds(30)) == std::future_status::ready, "continuation chain finishes");
+    Check(result.get() == 1000, "continuation chain runs every step");
+}
+
+
+/***
+ * Tasks posted from a worker go to its own queue, the other workers have to steal them to take part.
+ */
+static void TestStealing() {
+    TaskScheduler scheduler(4);
+
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::atomic<int> finished{0};
+
+    auto parent = scheduler.submit([&]() {
+        for (int i = 0; i < 64; i++) {
+            scheduler.post([&]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    threads.insert(std::this_thread::get_id());
+                }
+                finished++;
+            });
+        }
+    });
+    parent.get();
+    scheduler.shutdown();
+
+    Check(finished == 64, "all posted tasks run");
+    Check(threads.size() > 1, "idle workers steal tasks posted from another worker");
+}
+
+
+/***
+ * Shutting down waits for the queued tasks, including the ones they post, and a new task starts the workers again.
+ */
+static void TestShutdownWithQueuedTasks() {
+    TaskScheduler scheduler(2);
+
+    std::atomic<int> finished{0};
+    for (int i = 0; i < 200; i++) {
+        scheduler.post([&]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            scheduler.post([&]() { finished++; });
+            finished++;
+        });
+    }
+    scheduler.shutdown();
+
+    Check(finished == 400, "shutdown runs all queued tasks and their continuations");
+    Check(scheduler.queued() == 0, "no task is left after shutdown");
+
+    auto restarted = scheduler.submit([]() { return 7; });
+    Check(restarted.wait_for(std::chrono::seconds(30)) == std::future_status::ready && restarted.get() == 7,
+          "posting after shutdown starts the workers again");
+}
+
+
+/***
+ * Exceptions of a task end up in its future, and resizing from a task is rejected instead of deadlocking.
+ */
+static void TestErrors() {
+    TaskScheduler scheduler(2);
+
+    auto failing = scheduler.submit([]() -> int { throw std::runtime_error("task failed"); });
+    bool thrown = false;
+    try {
+        failing.get();
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    Check(thrown, "exception of a task is stored in its future");
+
+    auto resize = scheduler.submit([&scheduler]() {
+        try {
+            scheduler.resize(1);
+        } catch (const std::logic_error&) {
+            return true;
+        }
+        return false;
+    });
+    Check(resize.get(), "resize from a task throws");
+}
+
+
+/***
+ * The configured size keeps zero for the number of hardware threads, so restoring it keeps the automatic size.
+ */
+static void TestConfiguredSize() {
+    TaskScheduler scheduler(0);
+    scheduler.submit([]() {}).get();
+
+    Check(scheduler.configuredSize() == 0, "configured size of an automatic scheduler is zero");
+    Check(scheduler.size() >= 1, "automatic scheduler runs at least one worker");
+}
+
+
+int main() {
+    TestPostFromWorker();
+    TestStealing();
+    TestShutdownWithQueuedTasks();
+    TestErrors();
+    TestConfiguredSize();
+
+    if (failures == 0)
+        std::printf("All task scheduler tests passed.\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+import faulthandler
+import unittest
+
+import neuralpy
+
+
+def make_context():
+    params = neuralpy.Parameters()
+    params.SetMultiplicativeDepth(6)
+    params.SetFirstModSize(36)
+    params.SetScalingModSize(29)
+    params.SetSecurityLevel(neuralpy.HEStd_NotSet)
+    params.SetBatchSize(16)
+    params.SetScalingTechnique(neuralpy.FLEXIBLEAUTO)
+    params.SetRingDim(1024)
+
+    context = neuralpy.MakeContext(params)
+    context.Enable(neuralpy.PKE)
+    context.Enable(neuralpy.LEVELEDSHE)
+    context.Enable(neuralpy.ADVANCEDSHE)
+
+    keypair = context.KeyGen()
+    context.EvalMultKeyGen(keypair.privateKey)
+
+    return context, keypair
+
+
+class SetThreadsTest(unittest.TestCase):
+    def setUp(self):
+        self.previous = neuralpy.GetThreads()["inter_op"]
+        # A deadlock would hang the interpreter, so fail the run instead of waiting forever
+        faulthandler.dump_traceback_later(120, exit=True)
+
+    def tearDown(self):
+        faulthandler.cancel_dump_traceback_later()
+        neuralpy.SetThreads(inter_op=self.previous)
+
+    def test_resize_with_outstanding_futures(self):
+        context, keypair = make_context()
+        x = context.Encrypt(context.PackPlaintext([0.1 * i for i in range(16)]), keypair.publicKey)
+        model = neuralpy.Sequential([neuralpy.PolynomialActivation("relu", -2, 2, 15)], context=context)
+
+        futures = [model.submit(x) for _ in range(64)]
+
+        # Waits for the queued requests, which complete their futures with the GIL
+        neuralpy.SetThreads(inter_op=2)
+
+        for future in futures:
+            self.assertIsNotNone(future.result(timeout=60))
+        self.assertEqual(neuralpy.GetThreads()["inter_op"], 2)
+
+        # The scheduler starts again with the new number of threads
+        self.assertIsNotNone(model.submit(x).result(timeout=60))
+
+
+if __name__ == "__main__":
+    unittest.main()